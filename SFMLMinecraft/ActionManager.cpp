@@ -1,4 +1,5 @@
 #include "ActionManager.h"
+#include <cmath>
 
 ActionManager::ActionManager(float distanceMultiplier)
     : distanceMultiplier(distanceMultiplier) {
@@ -19,8 +20,7 @@ void ActionManager::stopAction(Character& character) {
 }
 
 bool ActionManager::handleMining(Character& character, TileMap& map, int tileX, int tileY,
-    const std::vector<int>& breakableTiles, const sf::Vector2u& tileSize,
-    float deltaTime, bool isMousePressed) {
+    const sf::Vector2u& tileSize, float deltaTime, bool isMousePressed) {
 
     // If we were mining but mouse is no longer pressed, stop
     if (currentAction == ActionType::Mining && !isMousePressed) {
@@ -63,7 +63,7 @@ bool ActionManager::handleMining(Character& character, TileMap& map, int tileX,
 
     // Check if breakable
     int tileID = map.getTile(static_cast<unsigned int>(tileX), static_cast<unsigned int>(tileY));
-    if (std::find(breakableTiles.begin(), breakableTiles.end(), tileID) == breakableTiles.end()) {
+    if (!isBreakableTile(tileID)) {
         if (progress.active) {
             stopAction(character);
         }
@@ -27,8 +27,7 @@ public:
         const sf::Vector2u& tileSize, float deltaTime, bool isMousePressed);
 
     bool handleMining(Character& character, TileMap& map, int tileX, int tileY,
-        const std::vector<int>& breakableTiles, const sf::Vector2u& tileSize,
-        float deltaTime, bool isMousePressed);
+        const sf::Vector2u& tileSize, float deltaTime, bool isMousePressed);
 
     void stopAction(Character& character);
 
@@ -1,70 +1,31 @@
 #include "CollisionManager.h"
+#include "TileCollision.h"
 
 
-bool CollisionManager::checkCollision(const sf::FloatRect& rect, const TileMap& map, const std::vector<int>& solidTiles) {
-    unsigned int tileWidth = map.getTileSize().x;
-    unsigned int tileHeight = map.getTileSize().y;
-    unsigned int map_width = map.getWidth();
-    unsigned int map_height = map.getHeight();
-
-    int leftTile = static_cast<int>(rect.position.x / static_cast<float>(tileWidth));
-    int rightTile = static_cast<int>((rect.position.x + rect.size.x - 1.f) / static_cast<float>(tileWidth));
-    int topTile = static_cast<int>(rect.position.y / static_cast<float>(tileHeight));
-    int bottomTile = static_cast<int>((rect.position.y + rect.size.y - 1.f) / static_cast<float>(tileHeight));
-
-    leftTile = std::max(0, leftTile);
-    rightTile = std::min(static_cast<int>(map_width) - 1, rightTile);
-    topTile = std::max(0, topTile);
-    bottomTile = std::min(static_cast<int>(map_height) - 1, bottomTile);
-
-    if (rightTile < 0 || leftTile > static_cast<int>(map_width) - 1 ||
-        bottomTile < 0 || topTile > static_cast<int>(map_height) - 1) {
-        return false;
-    }
-
-    for (int y = topTile; y <= bottomTile; ++y) {
-        for (int x = leftTile; x <= rightTile; ++x) {
-            int tile = map.getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
-            for (int solidTile : solidTiles) {
-                if (tile == solidTile) {
-                    return true;
-                }
-            }
-        }
+namespace {
+    TileRect toTileRect(const sf::FloatRect& rect) {
+        return { rect.position.x, rect.position.y, rect.size.x, rect.size.y };
     }
-    return false;
 }
 
-bool CollisionManager::checkHitboxCollision(const sf::FloatRect& hitbox, const TileMap& map, const std::vector<int>& solidTiles) {
-    int leftTile = static_cast<int>(hitbox.position.x / 46.f);
-    int rightTile = static_cast<int>((hitbox.position.x + hitbox.size.x) / 46.f);
-    int topTile = static_cast<int>(hitbox.position.y / 46.f);
-    int bottomTile = static_cast<int>((hitbox.position.y + hitbox.size.y) / 46.f);
-
-    for (int y = topTile; y <= bottomTile; ++y) {
-        for (int x = leftTile; x <= rightTile; ++x) {
-            if (x >= 0 && x < static_cast<int>(map.getWidth()) &&
-                y >= 0 && y < static_cast<int>(map.getHeight())) {
-
-                int tileID = map.getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+bool rectIntersects(const sf::FloatRect& rect1, const sf::FloatRect& rect2) {
+    return !(rect1.position.x > rect2.position.x + rect2.size.x ||
+        rect1.position.x + rect1.size.x < rect2.position.x ||
+        rect1.position.y > rect2.position.y + rect2.size.y ||
+        rect1.position.y + rect1.size.y < rect2.position.y);
+}
 
-                if (std::find(solidTiles.begin(), solidTiles.end(), tileID) != solidTiles.end()) {
-                    sf::FloatRect tileRect(
-                        sf::Vector2f(static_cast<float>(x * 46), static_cast<float>(y * 46)),
-                        sf::Vector2f(46.f, 46.f)
-                    );
+bool CollisionManager::checkCollision(const sf::FloatRect& rect, const TileMap& map) {
+    return rectCoversSolidTile(map.getTiles(), static_cast<float>(map.getTileSize().x),
+        static_cast<float>(map.getTileSize().y), toTileRect(rect));
+}
 
-                    if (hitbox.findIntersection(tileRect)) {
-                        return true;
-                    }
-                }
-            }
-        }
-    }
-    return false;
+bool CollisionManager::checkHitboxCollision(const sf::FloatRect& hitbox, const TileMap& map) {
+    return hitboxIntersectsSolidTile(map.getTiles(), static_cast<float>(map.getTileSize().x),
+        static_cast<float>(map.getTileSize().y), toTileRect(hitbox));
 }
 
-void CollisionManager::resolveCharacterCollision(Character& character, const TileMap& map, const std::vector<int>& solidTiles) {
+void CollisionManager::resolveCharacterCollision(Character& character, const TileMap& map) {
     sf::FloatRect hitbox = character.getHitbox();
 
     // vertical collision
@@ -72,7 +33,7 @@ void CollisionManager::resolveCharacterCollision(Character& character, const Til
     sf::FloatRect horizontalTest = hitbox;
     horizontalTest.position.x += horizontalMove.x;
 
-    if (checkHitboxCollision(horizontalTest, map, solidTiles)) {
+    if (checkHitboxCollision(horizontalTest, map)) {
         character.setVelocity(sf::Vector2f(0.f, character.getVelocity().y));
     }
 
@@ -81,7 +42,7 @@ void CollisionManager::resolveCharacterCollision(Character& character, const Til
     sf::FloatRect verticalTest = hitbox;
     verticalTest.position.y += verticalMove.y;
 
-    if (checkHitboxCollision(verticalTest, map, solidTiles)) {
+    if (checkHitboxCollision(verticalTest, map)) {
         // Ground collision
         if (character.getVelocity().y > 0) {
             character.setOnGround(true);
@@ -91,12 +52,12 @@ void CollisionManager::resolveCharacterCollision(Character& character, const Til
 }
 
 
-bool CollisionManager::checkGroundCollision(const Character& character, const TileMap& map, const std::vector<int>& solidTiles) {
+bool CollisionManager::checkGroundCollision(const Character& character, const TileMap& map) {
     sf::FloatRect hitbox = character.getHitbox();
     sf::FloatRect groundCheck = hitbox; //check under the hitbox
     groundCheck.position.y += 2.f;
 
-    return checkHitboxCollision(groundCheck, map, solidTiles);
+    return checkHitboxCollision(groundCheck, map);
 }
 
 void CollisionManager::drawHitbox(sf::RenderWindow& window, const Character& character) {
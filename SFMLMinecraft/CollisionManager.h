@@ -3,26 +3,25 @@
 #include "Character.h"
 #include "TileMap.h"
 
+bool rectIntersects(const sf::FloatRect& rect1, const sf::FloatRect& rect2);
+
+// SFML-facing wrapper over the headless queries in TileCollision.h
 class CollisionManager {
 public:
     static bool checkHitboxCollision(const sf::FloatRect& hitbox,
-        const TileMap& map,
-        const std::vector<int>& solidTiles);
+        const TileMap& map);
 
     static void resolveCharacterCollision(Character& character,
-        const TileMap& map,
-        const std::vector<int>& solidTiles);
+        const TileMap& map);
 
     static bool checkGroundCollision(const Character& character,
-        const TileMap& map,
-        const std::vector<int>& solidTiles);
+        const TileMap& map);
 
     static void drawHitbox(sf::RenderWindow& window,
         const Character& character);
 
     static bool checkCollision(const sf::FloatRect& rect, 
-        const TileMap& map, 
-        const std::vector<int>& solidTiles);
+        const TileMap& map);
 
 };
 
@@ -0,0 +1,63 @@
+#include "DirtyRegionTracker.h"
+#include <algorithm>
+
+void DirtyRegionTracker::resize(unsigned int chunksX, unsigned int chunksY)
+{
+    dirty_chunksX = chunksX;
+    dirty_bounds.assign(static_cast<std::size_t>(chunksX) * chunksY, Bounds{});
+    dirty_list.clear();
+}
+
+void DirtyRegionTracker::markTile(unsigned int x, unsigned int y)
+{
+    const unsigned int chunk = (x >> CHUNK_SHIFT) + (y >> CHUNK_SHIFT) * dirty_chunksX;
+    if (chunk >= dirty_bounds.size()) return;
+
+    Bounds& bounds = dirty_bounds[chunk];
+    const std::uint8_t lx = static_cast<std::uint8_t>(x & CHUNK_MASK);
+    const std::uint8_t ly = static_cast<std::uint8_t>(y & CHUNK_MASK);
+    if (bounds.minX > bounds.maxX) {
+        dirty_list.push_back(chunk);
+        bounds = { lx, ly, lx, ly };
+        return;
+    }
+    bounds.minX = std::min(bounds.minX, lx);
+    bounds.minY = std::min(bounds.minY, ly);
+    bounds.maxX = std::max(bounds.maxX, lx);
+    bounds.maxY = std::max(bounds.maxY, ly);
+}
+
+void DirtyRegionTracker::markRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    if (width == 0 || height == 0) return;
+
+    // Marking the corners of the rectangle's part in each chunk grows that chunk's box to cover it
+    const unsigned int right = x + width - 1;
+    const unsigned int bottom = y + height - 1;
+    for (unsigned int cy = y >> CHUNK_SHIFT; cy <= (bottom >> CHUNK_SHIFT); ++cy) {
+        const unsigned int top = std::max(y, cy << CHUNK_SHIFT);
+        const unsigned int low = std::min(bottom, (cy << CHUNK_SHIFT) + CHUNK_MASK);
+        for (unsigned int cx = x >> CHUNK_SHIFT; cx <= (right >> CHUNK_SHIFT); ++cx) {
+            const unsigned int left = std::max(x, cx << CHUNK_SHIFT);
+            const unsigned int end = std::min(right, (cx << CHUNK_SHIFT) + CHUNK_MASK);
+            markTile(left, top);
+            markTile(end, low);
+        }
+    }
+}
+
+void DirtyRegionTracker::drain(std::vector<DirtyRegion>& out)
+{
+    out.clear();
+    for (unsigned int chunk : dirty_list) {
+        Bounds& bounds = dirty_bounds[chunk];
+        const unsigned int cx = chunk % dirty_chunksX;
+        const unsigned int cy = chunk / dirty_chunksX;
+        out.push_back({ cx, cy,
+            (cx << CHUNK_SHIFT) + bounds.minX, (cy << CHUNK_SHIFT) + bounds.minY,
+            static_cast<unsigned int>(bounds.maxX - bounds.minX) + 1u,
+            static_cast<unsigned int>(bounds.maxY - bounds.minY) + 1u });
+        bounds = Bounds{};
+    }
+    dirty_list.clear();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "TileStorage.h"
+
+// Part of one chunk that changed: the bounding box of its changed tiles, in world tile coordinates
+struct DirtyRegion {
+    unsigned int chunkX;
+    unsigned int chunkY;
+    unsigned int left;
+    unsigned int top;
+    unsigned int width;
+    unsigned int height;
+};
+
+// Records which chunks changed, and where inside each, so consumers (meshing, lighting, saving,
+// networking) can work on the changed areas only. Marking is O(1) and allocation-free once the
+// dirty list has grown; draining hands over the regions and resets the tracker.
+class DirtyRegionTracker {
+public:
+    void resize(unsigned int chunksX, unsigned int chunksY);
+
+    void markTile(unsigned int x, unsigned int y);
+    void markRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+    bool empty() const { return dirty_list.empty(); }
+    std::size_t getDirtyChunkCount() const { return dirty_list.size(); }
+
+    // Replaces out with one region per dirty chunk, in the order the chunks first changed
+    void drain(std::vector<DirtyRegion>& out);
+
+private:
+    // Changed tiles inside one chunk, in chunk-local coordinates; empty while minX > maxX
+    struct Bounds {
+        std::uint8_t minX = 0xFF;
+        std::uint8_t minY = 0xFF;
+        std::uint8_t maxX = 0;
+        std::uint8_t maxY = 0;
+    };
+    static_assert(CHUNK_SIZE <= 256, "chunk-local bounds are stored in bytes");
+
+    std::vector<Bounds>         dirty_bounds; // per chunk
+    std::vector<unsigned int>   dirty_list;   // chunks with non-empty bounds
+    unsigned int                dirty_chunksX = 0;
+};
@@ -0,0 +1,156 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <fstream>
+
+const char* getFramePhaseName(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::Events:    return "Events";
+    case FramePhase::Input:     return "Input";
+    case FramePhase::Actions:   return "Actions";
+    case FramePhase::Physics:   return "Physics";
+    case FramePhase::Collision: return "Collision";
+    case FramePhase::World:     return "World";
+    case FramePhase::Camera:    return "Camera";
+    case FramePhase::Render:    return "Render";
+    case FramePhase::Present:   return "Present";
+    default:                    return "Unknown";
+    }
+}
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, FramePhase phase)
+    : profiler(profiler), phase(phase), start(Clock::now()) {
+}
+
+FrameProfiler::Scope::~Scope() {
+    profiler.addPhaseTime(phase, start, Clock::now());
+}
+
+FrameProfiler::FrameProfiler()
+    : origin(Clock::now()) {
+}
+
+double FrameProfiler::toMs(Clock::time_point time) const {
+    return std::chrono::duration<double, std::milli>(time - origin).count();
+}
+
+void FrameProfiler::beginFrame() {
+    frameStart = Clock::now();
+    current = FrameSample{};
+    current.frameIndex = frameCount.load(std::memory_order_relaxed);
+    current.frameStartMs = toMs(frameStart);
+    openPhase = FramePhase::Count;
+    inFrame = true;
+}
+
+void FrameProfiler::beginPhase(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    if (openPhase != FramePhase::Count) {
+        addPhaseTime(openPhase, phaseStart, now);
+    }
+    openPhase = phase;
+    phaseStart = now;
+}
+
+void FrameProfiler::addPhaseTime(FramePhase phase, Clock::time_point start, Clock::time_point end) {
+    if (!inFrame) return;
+    std::size_t index = static_cast<std::size_t>(phase);
+    // A phase that runs more than once per frame accumulates; its start stays the first one
+    if (current.phaseMs[index] == 0.f) {
+        current.phaseStartMs[index] = static_cast<float>(std::chrono::duration<double, std::milli>(start - frameStart).count());
+    }
+    current.phaseMs[index] += static_cast<float>(std::chrono::duration<double, std::milli>(end - start).count());
+}
+
+void FrameProfiler::endFrame() {
+    if (!inFrame) return;
+    Clock::time_point now = Clock::now();
+    if (openPhase != FramePhase::Count) {
+        addPhaseTime(openPhase, phaseStart, now);
+        openPhase = FramePhase::Count;
+    }
+    inFrame = false;
+    current.totalMs = static_cast<float>(std::chrono::duration<double, std::milli>(now - frameStart).count());
+
+    std::uint64_t index = frameCount.load(std::memory_order_relaxed);
+    Slot& slot = slots[index % HISTORY_SIZE];
+
+    std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sample = current;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    frameCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FrameSample> FrameProfiler::getHistory(std::size_t maxFrames) const {
+    std::uint64_t count = frameCount.load(std::memory_order_acquire);
+    std::uint64_t available = std::min<std::uint64_t>({ count, HISTORY_SIZE, maxFrames });
+
+    std::vector<FrameSample> history;
+    history.reserve(static_cast<std::size_t>(available));
+    for (std::uint64_t frame = count - available; frame < count; ++frame) {
+        const Slot& slot = slots[frame % HISTORY_SIZE];
+        FrameSample sample;
+        std::uint64_t before, after;
+        do {
+            before = slot.sequence.load(std::memory_order_acquire);
+            sample = slot.sample;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = slot.sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        // The writer lapped us and this slot already holds a newer frame
+        if (sample.frameIndex != frame) continue;
+        history.push_back(sample);
+    }
+    return history;
+}
+
+bool FrameProfiler::exportCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "frame,start_ms,total_ms";
+    for (std::size_t p = 0; p < FRAME_PHASE_COUNT; ++p) {
+        out << ',' << getFramePhaseName(static_cast<FramePhase>(p)) << "_ms";
+    }
+    out << '\n';
+
+    for (const FrameSample& sample : getHistory()) {
+        out << sample.frameIndex << ',' << sample.frameStartMs << ',' << sample.totalMs;
+        for (float ms : sample.phaseMs) {
+            out << ',' << ms;
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool FrameProfiler::exportChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    // Trace timestamps are microseconds
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto writeEvent = [&](const char* name, double startUs, double durationUs, std::uint64_t frame) {
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << startUs << ",\"dur\":" << durationUs
+            << ",\"args\":{\"frame\":" << frame << "}}";
+        first = false;
+    };
+
+    for (const FrameSample& sample : getHistory()) {
+        double frameStartUs = sample.frameStartMs * 1000.0;
+        writeEvent("Frame", frameStartUs, sample.totalMs * 1000.0, sample.frameIndex);
+        for (std::size_t p = 0; p < FRAME_PHASE_COUNT; ++p) {
+            if (sample.phaseMs[p] <= 0.f) continue;
+            writeEvent(getFramePhaseName(static_cast<FramePhase>(p)),
+                frameStartUs + sample.phaseStartMs[p] * 1000.0, sample.phaseMs[p] * 1000.0, sample.frameIndex);
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
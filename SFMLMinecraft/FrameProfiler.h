@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Main loop phases, in the order they run each frame
+enum class FramePhase {
+    Events,
+    Input,
+    Actions,
+    Physics,
+    Collision,
+    World,   // pulling in tiles changed by the simulation thread
+    Camera,
+    Render,
+    Present, // window.display(): buffer swap and frame limiter wait
+    Count
+};
+
+constexpr std::size_t FRAME_PHASE_COUNT = static_cast<std::size_t>(FramePhase::Count);
+
+const char* getFramePhaseName(FramePhase phase);
+
+// Timings of one finished frame. Times are milliseconds; phaseStart is relative to the frame start.
+struct FrameSample {
+    std::uint64_t frameIndex = 0;
+    double frameStartMs = 0.0; // since the profiler was created
+    float totalMs = 0.f;
+    std::array<float, FRAME_PHASE_COUNT> phaseStartMs{};
+    std::array<float, FRAME_PHASE_COUNT> phaseMs{};
+};
+
+// Per-phase frame timer. The game thread is the only writer; it fills a fixed ring buffer of the
+// last HISTORY_SIZE frames without locks or allocations. Readers (overlay, exporters, other
+// threads) copy frames out through a per-slot sequence counter and retry if a slot was rewritten
+// while they were reading it.
+class FrameProfiler {
+public:
+    static constexpr std::size_t HISTORY_SIZE = 256;
+
+    using Clock = std::chrono::steady_clock;
+
+    // RAII timer for one phase of the current frame
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, FramePhase phase);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        FrameProfiler& profiler;
+        FramePhase phase;
+        Clock::time_point start;
+    };
+
+    FrameProfiler();
+
+    void beginFrame();
+    void endFrame(); // also closes the phase opened by beginPhase()
+    void addPhaseTime(FramePhase phase, Clock::time_point start, Clock::time_point end);
+
+    // Marker style for straight-line loops: closes the previously begun phase and starts timing this one
+    void beginPhase(FramePhase phase);
+
+    // Copies up to maxFrames of the most recent finished frames, oldest first
+    std::vector<FrameSample> getHistory(std::size_t maxFrames = HISTORY_SIZE) const;
+    std::uint64_t getFrameCount() const { return frameCount.load(std::memory_order_acquire); }
+
+    // One row per frame: frame, start_ms, total_ms, then one column per phase
+    bool exportCsv(const std::string& path) const;
+    // Chrome trace event format (chrome://tracing, Perfetto): one complete event per phase
+    bool exportChromeTrace(const std::string& path) const;
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{ 0 }; // odd while being written
+        FrameSample sample;
+    };
+
+    double toMs(Clock::time_point time) const;
+
+    std::array<Slot, HISTORY_SIZE> slots;
+    std::atomic<std::uint64_t> frameCount{ 0 }; // frames published so far
+
+    // Frame being recorded, only touched by the writer
+    FrameSample current;
+    Clock::time_point origin;
+    Clock::time_point frameStart;
+    Clock::time_point phaseStart;
+    FramePhase openPhase = FramePhase::Count; // Count: no marker phase open
+    bool inFrame = false;
+};
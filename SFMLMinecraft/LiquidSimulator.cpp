@@ -0,0 +1,212 @@
+#include "LiquidSimulator.h"
+#include <algorithm>
+
+void LiquidSimulator::reset(const TileStorage& tiles)
+{
+    clear(tiles);
+
+    // Only loaded chunks can hold liquid
+    for (unsigned int cy = 0; cy < tiles.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < tiles.getChunksX(); ++cx) {
+            const Chunk* chunk = tiles.getChunk(cx, cy);
+            if (!chunk) continue;
+
+            const unsigned int x0 = cx << CHUNK_SHIFT;
+            const unsigned int y0 = cy << CHUNK_SHIFT;
+            const unsigned int y1 = std::min(y0 + CHUNK_SIZE, sim_height);
+            for (unsigned int y = y0; y < y1; ++y) {
+                for (std::uint64_t bits = chunk->water[y - y0] | chunk->lava[y - y0]; bits; bits &= bits - 1) {
+                    queue(static_cast<std::uint32_t>(x0 + lowestSetBit(bits) + y * sim_width));
+                }
+            }
+        }
+    }
+}
+
+void LiquidSimulator::clear(const TileStorage& tiles)
+{
+    sim_width = tiles.getWidth();
+    sim_height = tiles.getHeight();
+    const std::size_t words = (static_cast<std::size_t>(sim_width) * sim_height + 63) / 64;
+    sim_queued.assign(words, 0);
+    sim_changedBits.assign(words, 0);
+    sim_active.clear();
+    sim_changed.clear();
+}
+
+void LiquidSimulator::wake(unsigned int x, unsigned int y)
+{
+    if (x >= sim_width || y >= sim_height) return;
+    queueNeighbourhood(x + y * sim_width);
+}
+
+void LiquidSimulator::queue(std::uint32_t cell)
+{
+    if (testBit(sim_queued, cell)) return;
+    setBit(sim_queued, cell);
+    sim_active.push_back(cell);
+}
+
+void LiquidSimulator::queueNeighbourhood(std::uint32_t cell)
+{
+    const unsigned int x = cell % sim_width;
+    const unsigned int y = cell / sim_width;
+    queue(cell);
+    if (x > 0) queue(cell - 1);
+    if (x + 1 < sim_width) queue(cell + 1);
+    if (y > 0) queue(cell - sim_width);
+    if (y + 1 < sim_height) queue(cell + sim_width);
+}
+
+void LiquidSimulator::markChanged(std::uint32_t cell)
+{
+    if (!testBit(sim_changedBits, cell)) {
+        setBit(sim_changedBits, cell);
+        sim_changed.push_back(cell);
+    }
+    // A change can free or block the cells around it, or put water next to lava
+    queueNeighbourhood(cell);
+}
+
+void LiquidSimulator::sortByScanOrder()
+{
+    // Same visiting order as the full-grid passes: bottom row first, left to right
+    const unsigned int width = sim_width;
+    std::sort(sim_active.begin(), sim_active.end(), [width](std::uint32_t a, std::uint32_t b) {
+        const std::uint32_t rowA = a / width;
+        const std::uint32_t rowB = b / width;
+        return rowA != rowB ? rowA > rowB : a < b;
+    });
+}
+
+bool LiquidSimulator::canMove(const TileStorage& tiles, std::uint32_t cell) const
+{
+    const unsigned int x = cell % sim_width;
+    const unsigned int y = cell / sim_width;
+    if (!isLiquidTile(tiles.getTile(x, y))) return false;
+    return (y + 1 < sim_height && tiles.getTile(x, y + 1) == TILE_AIR)
+        || (x > 0 && tiles.getTile(x - 1, y) == TILE_AIR)
+        || (x + 1 < sim_width && tiles.getTile(x + 1, y) == TILE_AIR);
+}
+
+std::size_t LiquidSimulator::countFalling(const TileStorage& tiles) const
+{
+    std::size_t falling = 0;
+    for (std::uint32_t cell : sim_active) {
+        const unsigned int x = cell % sim_width;
+        const unsigned int y = cell / sim_width;
+        falling += y + 1 < sim_height && isLiquidTile(tiles.getTile(x, y)) && tiles.getTile(x, y + 1) == TILE_AIR;
+    }
+    return falling;
+}
+
+std::size_t LiquidSimulator::countLevelling(const TileStorage& tiles) const
+{
+    std::size_t levelling = 0;
+    for (std::uint32_t cell : sim_active) {
+        const unsigned int x = cell % sim_width;
+        const unsigned int y = cell / sim_width;
+        if (y == 0 || !isLiquidTile(tiles.getTile(x, y)) || !isLiquidTile(tiles.getTile(x, y - 1))) continue;
+        if ((x > 0 && tiles.getTile(x - 1, y) == TILE_AIR) || (x + 1 < sim_width && tiles.getTile(x + 1, y) == TILE_AIR)) {
+            ++levelling;
+        }
+    }
+    return levelling;
+}
+
+void LiquidSimulator::flowPass(TileStorage& tiles, Tile liquid)
+{
+    const bool lava = liquid == TILE_LAVA;
+    const RandomPurpose sidePurpose = lava ? RandomPurpose::LavaFlow : RandomPurpose::WaterFlow;
+
+    // Decide every move against the tiles as they were before the pass, then apply them in scan
+    // order. That is the same result as the full-grid pass writing into a copy of the world.
+    sortByScanOrder();
+    sim_moves.clear();
+    for (std::uint32_t cell : sim_active) {
+        const unsigned int x = cell % sim_width;
+        const unsigned int y = cell / sim_width;
+        if (tiles.getTile(x, y) != liquid) continue;
+
+        if (y + 1 < sim_height && tiles.getTile(x, y + 1) == TILE_AIR) {
+            sim_moves.push_back({ cell, cell + sim_width });
+            continue;
+        }
+
+        if (lava && randomInt({ sim_seed, static_cast<int>(x), static_cast<int>(y), RandomPurpose::LavaSpread, sim_tick }, 0, 2) != 0) {
+            continue;
+        }
+
+        const bool canFlowLeft = x > 0 && tiles.getTile(x - 1, y) == TILE_AIR;
+        const bool canFlowRight = x + 1 < sim_width && tiles.getTile(x + 1, y) == TILE_AIR;
+        if (canFlowLeft && canFlowRight) {
+            const bool left = randomInt({ sim_seed, static_cast<int>(x), static_cast<int>(y), sidePurpose, sim_tick }, 0, 1) == 0;
+            sim_moves.push_back({ cell, left ? cell - 1 : cell + 1 });
+        }
+        else if (canFlowLeft) {
+            sim_moves.push_back({ cell, cell - 1 });
+        }
+        else if (canFlowRight) {
+            sim_moves.push_back({ cell, cell + 1 });
+        }
+    }
+
+    sim_moveCount += sim_moves.size();
+    for (const Move& move : sim_moves) {
+        tiles.setTile(move.to % sim_width, move.to / sim_width, liquid);
+        tiles.setTile(move.from % sim_width, move.from / sim_width, TILE_AIR);
+        markChanged(move.to);
+        markChanged(move.from);
+    }
+}
+
+void LiquidSimulator::interactionPass(TileStorage& tiles)
+{
+    // Water never changes here and lava only turns into obsidian, so the visiting order does not
+    // matter: every lava cell touching water hardens.
+    const std::size_t count = sim_active.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t cell = sim_active[i];
+        const unsigned int x = cell % sim_width;
+        const unsigned int y = cell / sim_width;
+        if (tiles.getTile(x, y) != TILE_LAVA) continue;
+
+        const bool touchesWater = (x > 0 && tiles.getTile(x - 1, y) == TILE_WATER)
+            || (x + 1 < sim_width && tiles.getTile(x + 1, y) == TILE_WATER)
+            || (y > 0 && tiles.getTile(x, y - 1) == TILE_WATER)
+            || (y + 1 < sim_height && tiles.getTile(x, y + 1) == TILE_WATER);
+        if (touchesWater) {
+            tiles.setTile(x, y, TILE_OBSIDIAN);
+            markChanged(cell);
+            ++sim_hardenedCount;
+        }
+    }
+}
+
+void LiquidSimulator::step(TileStorage& tiles)
+{
+    for (std::uint32_t cell : sim_changed) clearBit(sim_changedBits, cell);
+    sim_changed.clear();
+    sim_moveCount = 0;
+    sim_hardenedCount = 0;
+
+    if (!sim_active.empty()) {
+        flowPass(tiles, TILE_WATER);
+        flowPass(tiles, TILE_LAVA);
+        interactionPass(tiles);
+
+        // Keep only liquid that can still move; everything else sleeps until something wakes it
+        std::size_t kept = 0;
+        for (std::uint32_t cell : sim_active) {
+            if (canMove(tiles, cell)) {
+                sim_active[kept++] = cell;
+            }
+            else {
+                clearBit(sim_queued, cell);
+            }
+        }
+        sim_active.resize(kept);
+    }
+
+    ++sim_tick;
+}
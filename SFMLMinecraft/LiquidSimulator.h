@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "TileStorage.h"
+#include "WorldRandom.h"
+
+// Active-set liquid engine. Instead of scanning the whole map every tick it only visits liquid
+// cells that can still move (plus the neighbours of anything that changed), so a tick costs
+// time proportional to the moving liquid, not to the world area.
+// The rules and random streams are the same as updateWorld(): stepping the simulator with tick N
+// gives exactly the tiles that updateWorld(tiles, seed, N) would.
+class LiquidSimulator {
+public:
+    explicit LiquidSimulator(WorldSeed seed = 0) : sim_seed(seed) {}
+
+    // Scans the world once and activates every liquid cell. Call after loading or generating a world.
+    void reset(const TileStorage& tiles);
+    // Sizes the simulator for the world with nothing active; wake() then picks the cells to watch
+    void clear(const TileStorage& tiles);
+
+    // Something changed at (x, y) outside the simulator: re-check the cell and its four neighbours
+    void wake(unsigned int x, unsigned int y);
+
+    // One liquid tick: water flow, lava flow, then water/lava interactions
+    void step(TileStorage& tiles);
+
+    // Cells written by the last step(), as x + y * width (each listed once)
+    const std::vector<std::uint32_t>& getChangedCells() const { return sim_changed; }
+
+    // What the last step() did: liquid cells moved, lava hardened
+    std::size_t getMoveCount() const { return sim_moveCount; }
+    std::size_t getHardenedCount() const { return sim_hardenedCount; }
+
+    std::size_t getActiveCount() const { return sim_active.size(); }
+    // Active liquid with air right below it, which falls next tick. After a step every liquid
+    // cell that can move is active, so 0 means all liquid rests on something.
+    std::size_t countFalling(const TileStorage& tiles) const;
+    // Active liquid with air beside it and more liquid on top: a pool still levelling out. Only
+    // films, one cell thick, are left moving once this is 0.
+    std::size_t countLevelling(const TileStorage& tiles) const;
+    std::uint32_t getTick() const { return sim_tick; }
+    WorldSeed getSeed() const { return sim_seed; }
+
+private:
+    struct Move {
+        std::uint32_t from;
+        std::uint32_t to;
+    };
+
+    void queue(std::uint32_t cell);
+    void queueNeighbourhood(std::uint32_t cell);
+    void markChanged(std::uint32_t cell);
+    void sortByScanOrder();
+    void flowPass(TileStorage& tiles, Tile liquid);
+    void interactionPass(TileStorage& tiles);
+    bool canMove(const TileStorage& tiles, std::uint32_t cell) const;
+
+    static bool testBit(const std::vector<std::uint64_t>& bits, std::uint32_t cell) { return (bits[cell >> 6] >> (cell & 63)) & 1u; }
+    static void setBit(std::vector<std::uint64_t>& bits, std::uint32_t cell) { bits[cell >> 6] |= std::uint64_t{ 1 } << (cell & 63); }
+    static void clearBit(std::vector<std::uint64_t>& bits, std::uint32_t cell) { bits[cell >> 6] &= ~(std::uint64_t{ 1 } << (cell & 63)); }
+
+    WorldSeed                   sim_seed;
+    std::uint32_t               sim_tick = 0;
+    unsigned int                sim_width = 0;
+    unsigned int                sim_height = 0;
+    std::vector<std::uint32_t>  sim_active;    // cells to visit next tick
+    std::vector<std::uint64_t>  sim_queued;    // one bit per cell: already in sim_active
+    std::vector<std::uint32_t>  sim_changed;
+    std::vector<std::uint64_t>  sim_changedBits;
+    std::vector<Move>           sim_moves;     // scratch, reused between ticks
+    std::size_t                 sim_moveCount = 0;
+    std::size_t                 sim_hardenedCount = 0;
+};
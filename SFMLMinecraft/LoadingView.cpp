@@ -0,0 +1,58 @@
+#include "LoadingView.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const sf::Color BACKGROUND(24, 28, 36);
+    const sf::Color COLUMN_PENDING(60, 66, 80);
+    const sf::Color COLUMN_DONE(110, 180, 80);
+    const sf::Color COLUMN_SPAWN(240, 210, 90);
+    const sf::Color BAR_FILL(90, 150, 230);
+
+    constexpr float PANEL_WIDTH = 420.f;
+    constexpr float BAR_HEIGHT = 14.f;
+    constexpr float COLUMN_HEIGHT = 24.f;
+}
+
+LoadingView::LoadingView(const sf::Font* font)
+    : font(font) {
+}
+
+void LoadingView::draw(sf::RenderWindow& window, const WorldGenerationProgress& progress) const {
+    window.setView(window.getDefaultView());
+    window.clear(BACKGROUND);
+
+    const sf::Vector2f size(window.getSize());
+    const sf::Vector2f origin((size.x - PANEL_WIDTH) * 0.5f, size.y * 0.5f - 40.f);
+
+    if (font) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "%s... %d%%", progress.getStageLabel(),
+            static_cast<int>(progress.getFraction() * 100.f + 0.5f));
+        sf::Text text(*font, line, 18);
+        text.setPosition(origin);
+        window.draw(text);
+    }
+
+    // Overall progress
+    const sf::Vector2f barOrigin = origin + sf::Vector2f(0.f, 32.f);
+    sf::RectangleShape bar({ PANEL_WIDTH, BAR_HEIGHT });
+    bar.setPosition(barOrigin);
+    bar.setFillColor(COLUMN_PENDING);
+    window.draw(bar);
+    bar.setSize({ PANEL_WIDTH * std::clamp(progress.getFraction(), 0.f, 1.f), BAR_HEIGHT });
+    bar.setFillColor(BAR_FILL);
+    window.draw(bar);
+
+    // Chunk columns, filled from the spawn column outwards once per stage
+    const unsigned int columns = progress.getChunksX();
+    if (columns == 0) return;
+    const float cellWidth = PANEL_WIDTH / static_cast<float>(columns);
+    sf::RectangleShape cell({ std::max(1.f, cellWidth - 1.f), COLUMN_HEIGHT });
+    for (unsigned int cx = 0; cx < columns; ++cx) {
+        cell.setPosition(barOrigin + sf::Vector2f(cellWidth * static_cast<float>(cx), BAR_HEIGHT + 10.f));
+        cell.setFillColor(!progress.isColumnDone(cx) ? COLUMN_PENDING
+            : cx == progress.getSpawnChunkX() ? COLUMN_SPAWN : COLUMN_DONE);
+        window.draw(cell);
+    }
+}
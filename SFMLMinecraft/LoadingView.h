@@ -0,0 +1,16 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "WorldGenerationJob.h"
+
+// Shown while the world is generated in the background: the current stage, an overall progress
+// bar, and one cell per chunk column that lights up as the stage finishes it (spawn outwards).
+class LoadingView {
+public:
+    explicit LoadingView(const sf::Font* font); // font may be null: bars only
+
+    // Draws in screen space with the window's default view
+    void draw(sf::RenderWindow& window, const WorldGenerationProgress& progress) const;
+
+private:
+    const sf::Font* font;
+};
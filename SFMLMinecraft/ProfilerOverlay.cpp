@@ -0,0 +1,109 @@
+#include "ProfilerOverlay.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const sf::Color PHASE_COLORS[FRAME_PHASE_COUNT] = {
+        sf::Color(230, 80, 80),   // Events
+        sf::Color(240, 160, 60),  // Input
+        sf::Color(240, 220, 70),  // Actions
+        sf::Color(120, 210, 90),  // Physics
+        sf::Color(70, 190, 190),  // Collision
+        sf::Color(60, 110, 200),  // World
+        sf::Color(90, 130, 240),  // Camera
+        sf::Color(170, 100, 230), // Render
+        sf::Color(140, 140, 140)  // Present
+    };
+
+    constexpr std::size_t GRAPH_FRAMES = 120;
+    constexpr float GRAPH_HEIGHT = 80.f;
+    constexpr float GRAPH_MS = 33.3f; // top of the graph
+}
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font* font)
+    : font(font) {
+}
+
+void ProfilerOverlay::draw(sf::RenderWindow& window, const FrameProfiler& profiler) const {
+    if (!isVisible) return;
+
+    std::vector<FrameSample> history = profiler.getHistory(GRAPH_FRAMES);
+    if (history.empty()) return;
+
+    const sf::Vector2f origin(10.f, 10.f);
+    const float lineHeight = 16.f;
+    const float panelWidth = 330.f;
+    const float panelHeight = 24.f + lineHeight * (FRAME_PHASE_COUNT + 1) + GRAPH_HEIGHT;
+
+    sf::RectangleShape background({ panelWidth, panelHeight });
+    background.setPosition(origin);
+    background.setFillColor(sf::Color(0, 0, 0, 170));
+    window.draw(background);
+
+    // Per-phase statistics over the shown frames
+    std::array<float, FRAME_PHASE_COUNT> average{};
+    std::array<float, FRAME_PHASE_COUNT> maximum{};
+    float averageTotal = 0.f;
+    float maximumTotal = 0.f;
+    for (const FrameSample& sample : history) {
+        for (std::size_t p = 0; p < FRAME_PHASE_COUNT; ++p) {
+            average[p] += sample.phaseMs[p];
+            maximum[p] = std::max(maximum[p], sample.phaseMs[p]);
+        }
+        averageTotal += sample.totalMs;
+        maximumTotal = std::max(maximumTotal, sample.totalMs);
+    }
+    for (float& value : average) value /= static_cast<float>(history.size());
+    averageTotal /= static_cast<float>(history.size());
+
+    if (font) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "Frame      avg %6.2f  max %6.2f ms", averageTotal, maximumTotal);
+        sf::Text text(*font, line, 12);
+        text.setPosition(origin + sf::Vector2f(8.f, 6.f));
+        window.draw(text);
+
+        for (std::size_t p = 0; p < FRAME_PHASE_COUNT; ++p) {
+            std::snprintf(line, sizeof(line), "%-10s avg %6.2f  max %6.2f ms",
+                getFramePhaseName(static_cast<FramePhase>(p)), average[p], maximum[p]);
+            text.setString(line);
+            text.setFillColor(PHASE_COLORS[p]);
+            text.setPosition(origin + sf::Vector2f(8.f, 6.f + lineHeight * static_cast<float>(p + 1)));
+            window.draw(text);
+        }
+    }
+
+    // Stacked bars, one per frame, newest on the right
+    const float graphTop = origin.y + 16.f + lineHeight * (FRAME_PHASE_COUNT + 1);
+    const float barWidth = (panelWidth - 16.f) / static_cast<float>(GRAPH_FRAMES);
+    const float pixelsPerMs = GRAPH_HEIGHT / GRAPH_MS;
+
+    sf::VertexArray bars(sf::PrimitiveType::Triangles);
+    std::size_t firstSlot = GRAPH_FRAMES - history.size();
+    for (std::size_t i = 0; i < history.size(); ++i) {
+        float left = origin.x + 8.f + barWidth * static_cast<float>(firstSlot + i);
+        float right = left + std::max(1.f, barWidth - 1.f);
+        float bottom = graphTop + GRAPH_HEIGHT;
+        for (std::size_t p = 0; p < FRAME_PHASE_COUNT; ++p) {
+            float height = history[i].phaseMs[p] * pixelsPerMs;
+            float top = std::max(graphTop, bottom - height);
+            if (bottom - top < 0.5f) continue;
+            const sf::Color& color = PHASE_COLORS[p];
+            bars.append({ { left, top }, color });
+            bars.append({ { right, top }, color });
+            bars.append({ { left, bottom }, color });
+            bars.append({ { right, top }, color });
+            bars.append({ { right, bottom }, color });
+            bars.append({ { left, bottom }, color });
+            bottom = top;
+        }
+    }
+    window.draw(bars);
+
+    // 60 FPS budget line
+    float budgetY = graphTop + GRAPH_HEIGHT - 16.67f * pixelsPerMs;
+    sf::RectangleShape budgetLine({ panelWidth - 16.f, 1.f });
+    budgetLine.setPosition({ origin.x + 8.f, budgetY });
+    budgetLine.setFillColor(sf::Color(255, 255, 255, 120));
+    window.draw(budgetLine);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "FrameProfiler.h"
+
+// Debug overlay for FrameProfiler: per-phase averages/maximums and a stacked bar graph of recent frames
+class ProfilerOverlay {
+public:
+    explicit ProfilerOverlay(const sf::Font* font); // font may be null: graph only
+
+    void toggle() { isVisible = !isVisible; }
+    bool getVisible() const { return isVisible; }
+
+    // Draws in screen space; the caller sets the default view
+    void draw(sf::RenderWindow& window, const FrameProfiler& profiler) const;
+
+private:
+    const sf::Font* font;
+    bool isVisible = false;
+};
@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+    }
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        pool_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        pool_stop = true;
+    }
+    pool_wake.notify_all();
+    for (std::thread& worker : pool_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+    if (count == 0) return;
+    if (pool_workers.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        pool_job = &job;
+        pool_count = count;
+        pool_next.store(0, std::memory_order_relaxed);
+        ++pool_generation;
+    }
+    pool_wake.notify_all();
+
+    runJobs();
+
+    // Workers that picked up this generation must leave before job goes out of scope
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    pool_done.wait(lock, [this] { return pool_busy == 0; });
+    pool_job = nullptr;
+}
+
+void ThreadPool::runJobs()
+{
+    for (;;) {
+        const std::size_t i = pool_next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= pool_count) break;
+        (*pool_job)(i);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+            pool_wake.wait(lock, [&] { return pool_stop || (pool_generation != seen && pool_job); });
+            if (pool_stop) return;
+            seen = pool_generation;
+            ++pool_busy;
+        }
+
+        runJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            --pool_busy;
+        }
+        pool_done.notify_one();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel world work (liquid strips, generation columns).
+// Work is handed out as index ranges; the calling thread helps too, so a pool of one thread
+// still runs everything, just serially.
+class ThreadPool {
+public:
+    // 0 = one thread per hardware core
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total threads that run work, including the caller of parallelFor
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(pool_workers.size()) + 1; }
+
+    // Calls job(i) for every i in [0, count) and returns once all calls have finished.
+    // Calls may run in any order and on any thread. Not reentrant.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+    void workerLoop();
+    void runJobs();
+
+    std::vector<std::thread>                    pool_workers;
+    std::mutex                                  pool_mutex;
+    std::condition_variable                     pool_wake;
+    std::condition_variable                     pool_done;
+    const std::function<void(std::size_t)>*     pool_job = nullptr;
+    std::size_t                                 pool_count = 0;
+    std::atomic<std::size_t>                    pool_next{ 0 };
+    std::size_t                                 pool_busy = 0;       // workers inside runJobs
+    std::uint64_t                               pool_generation = 0; // bumped for every parallelFor
+    bool                                        pool_stop = false;
+};
@@ -0,0 +1,63 @@
+#include "TileCollision.h"
+#include <algorithm>
+
+bool rectCoversSolidTile(const TileStorage& tiles, float tileWidth, float tileHeight, const TileRect& rect) {
+    int mapWidth = static_cast<int>(tiles.getWidth());
+    int mapHeight = static_cast<int>(tiles.getHeight());
+
+    int leftTile = static_cast<int>(rect.left / tileWidth);
+    int rightTile = static_cast<int>((rect.left + rect.width - 1.f) / tileWidth);
+    int topTile = static_cast<int>(rect.top / tileHeight);
+    int bottomTile = static_cast<int>((rect.top + rect.height - 1.f) / tileHeight);
+
+    leftTile = std::max(0, leftTile);
+    rightTile = std::min(mapWidth - 1, rightTile);
+    topTile = std::max(0, topTile);
+    bottomTile = std::min(mapHeight - 1, bottomTile);
+
+    if (rightTile < 0 || leftTile > mapWidth - 1 ||
+        bottomTile < 0 || topTile > mapHeight - 1) {
+        return false;
+    }
+
+    for (int y = topTile; y <= bottomTile; ++y) {
+        for (int x = leftTile; x <= rightTile; ++x) {
+            if (isSolidTile(tiles.getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y)))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool hitboxIntersectsSolidTile(const TileStorage& tiles, float tileWidth, float tileHeight, const TileRect& hitbox) {
+    int mapWidth = static_cast<int>(tiles.getWidth());
+    int mapHeight = static_cast<int>(tiles.getHeight());
+
+    int leftTile = std::max(0, static_cast<int>(hitbox.left / tileWidth));
+    int rightTile = std::min(mapWidth - 1, static_cast<int>((hitbox.left + hitbox.width) / tileWidth));
+    int topTile = std::max(0, static_cast<int>(hitbox.top / tileHeight));
+    int bottomTile = std::min(mapHeight - 1, static_cast<int>((hitbox.top + hitbox.height) / tileHeight));
+
+    float hitboxRight = hitbox.left + hitbox.width;
+    float hitboxBottom = hitbox.top + hitbox.height;
+
+    for (int y = topTile; y <= bottomTile; ++y) {
+        for (int x = leftTile; x <= rightTile; ++x) {
+            if (!isSolidTile(tiles.getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y)))) continue;
+
+            // Same test as sf::FloatRect::findIntersection: the overlap must have a positive area
+            float tileLeft = static_cast<float>(x) * tileWidth;
+            float tileTop = static_cast<float>(y) * tileHeight;
+            float overlapLeft = std::max(hitbox.left, tileLeft);
+            float overlapRight = std::min(hitboxRight, tileLeft + tileWidth);
+            float overlapTop = std::max(hitbox.top, tileTop);
+            float overlapBottom = std::min(hitboxBottom, tileTop + tileHeight);
+
+            if (overlapLeft < overlapRight && overlapTop < overlapBottom) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "TileStorage.h"
+
+// Axis-aligned rectangle in world pixels. Mirrors sf::FloatRect so the collision
+// queries can run without SFML (headless simulation, benchmarks, servers).
+struct TileRect {
+    float left = 0.f;
+    float top = 0.f;
+    float width = 0.f;
+    float height = 0.f;
+};
+
+// True when any solid tile touches the cells covered by rect (edges treated as inclusive - 1px)
+bool rectCoversSolidTile(const TileStorage& tiles, float tileWidth, float tileHeight, const TileRect& rect);
+
+// True when rect overlaps a solid tile with a non-zero area
+bool hitboxIntersectsSolidTile(const TileStorage& tiles, float tileWidth, float tileHeight, const TileRect& hitbox);
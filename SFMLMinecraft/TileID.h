@@ -1,4 +1,6 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <vector>
 
 enum TileID {
@@ -74,32 +76,122 @@ enum TileID {
     TOOL_SHOVEL = 1003
 };
 
-// inline vectors you can use at runtime to check membership.
-inline const std::vector<int> TILE_CATEGORY_TERRAIN = {
-    TILE_GRAVEL, TILE_STONE, TILE_DIRT, TILE_GRASS, TILE_SAND, TILE_COBBLESTONE, TILE_BEDROCK
-};
-
-inline const std::vector<int> TILE_CATEGORY_WOOD = {
-    TILE_LOG, TILE_DARK_LOG, TILE_WHITE_LOG, TILE_LEAVES, TILE_PLANKS
+// Compact storage type for a tile cell. Every TileID (including tools, which reach 1003)
+// fits in 16 bits, halving tile memory compared to int.
+using Tile = std::int16_t;
+
+static_assert(TILE_AIR >= INT16_MIN && TOOL_SHOVEL <= INT16_MAX, "TileID values must fit in Tile");
+
+// Per-tile property flags. A tile can carry several (e.g. pumpkin is decorative and a plant).
+enum TileFlag : std::uint16_t {
+    TILE_FLAG_NONE       = 0,
+    TILE_FLAG_SOLID      = 1 << 0,  // blocks movement
+    TILE_FLAG_BREAKABLE  = 1 << 1,  // can be mined
+    TILE_FLAG_LIQUID     = 1 << 2,
+    TILE_FLAG_LIGHT      = 1 << 3,  // emits light
+    TILE_FLAG_PLANT      = 1 << 4,
+    TILE_FLAG_TERRAIN    = 1 << 5,
+    TILE_FLAG_WOOD       = 1 << 6,
+    TILE_FLAG_ORE        = 1 << 7,
+    TILE_FLAG_DECORATIVE = 1 << 8
 };
 
-inline const std::vector<int> TILE_CATEGORY_ORES = {
-    TILE_GOLD_ORE, TILE_IRON_ORE, TILE_COAL_ORE, TILE_DIAMOND_ORE, TILE_RUBY_ORE, TILE_LAPIS_ORE, TILE_IRON_BLOCK, TILE_GOLD_BLOCK,
-    TILE_DIAMOND_BLOCK
+struct TileInfo {
+    TileID id;
+    std::uint16_t flags;
 };
 
-inline const std::vector<int> TILE_CATEGORY_DECORATIVE = {
-    TILE_BRICKS, TILE_BOOKSHELF, TILE_MOSSY_COBBLESTONE, TILE_OBSIDIAN, TILE_LAPIS_BLOCK, TILE_CRAFTING_TABLE, TILE_ENCHANTING_TABLE,
-    TILE_CHEST, TILE_FURNACE, TILE_TNT, TILE_TORCH, TILE_PUMPKIN, TILE_MELON, TILE_CAKE,
+// Single source of truth for tile properties. The order here is also the order tiles
+// appear in the TILE_CATEGORY_* lists (and therefore in the inventory panel).
+inline constexpr TileInfo TILE_INFO[] = {
+    { TILE_AIR,               TILE_FLAG_NONE },
+
+    { TILE_GRAVEL,            TILE_FLAG_TERRAIN },
+    { TILE_STONE,             TILE_FLAG_TERRAIN | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_DIRT,              TILE_FLAG_TERRAIN | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_GRASS,             TILE_FLAG_TERRAIN | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_SAND,              TILE_FLAG_TERRAIN | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_COBBLESTONE,       TILE_FLAG_TERRAIN | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_BEDROCK,           TILE_FLAG_TERRAIN | TILE_FLAG_SOLID },
+
+    { TILE_LOG,               TILE_FLAG_WOOD | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_DARK_LOG,          TILE_FLAG_WOOD | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_WHITE_LOG,         TILE_FLAG_WOOD | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_LEAVES,            TILE_FLAG_WOOD | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_PLANKS,            TILE_FLAG_WOOD | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+
+    { TILE_GOLD_ORE,          TILE_FLAG_ORE },
+    { TILE_IRON_ORE,          TILE_FLAG_ORE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_COAL_ORE,          TILE_FLAG_ORE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_DIAMOND_ORE,       TILE_FLAG_ORE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_RUBY_ORE,          TILE_FLAG_ORE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_LAPIS_ORE,         TILE_FLAG_ORE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_IRON_BLOCK,        TILE_FLAG_ORE | TILE_FLAG_SOLID },
+    { TILE_GOLD_BLOCK,        TILE_FLAG_ORE | TILE_FLAG_SOLID },
+    { TILE_DIAMOND_BLOCK,     TILE_FLAG_ORE | TILE_FLAG_SOLID },
+
+    { TILE_BRICKS,            TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID },
+    { TILE_BOOKSHELF,         TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_MOSSY_COBBLESTONE, TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_OBSIDIAN,          TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_LAPIS_BLOCK,       TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID },
+    { TILE_CRAFTING_TABLE,    TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_ENCHANTING_TABLE,  TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_CHEST,             TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID },
+    { TILE_FURNACE,           TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_TNT,               TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_TORCH,             TILE_FLAG_DECORATIVE | TILE_FLAG_LIGHT },
+
+    { TILE_FLOWER_RED,        TILE_FLAG_PLANT },
+    { TILE_FLOWER_YELLOW,     TILE_FLAG_PLANT },
+    { TILE_MUSHROOM_RED,      TILE_FLAG_PLANT },
+    { TILE_MUSHROOM_BROWN,    TILE_FLAG_PLANT },
+    { TILE_PUMPKIN,           TILE_FLAG_DECORATIVE | TILE_FLAG_PLANT | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_MELON,             TILE_FLAG_DECORATIVE | TILE_FLAG_PLANT | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+    { TILE_CAKE,              TILE_FLAG_DECORATIVE | TILE_FLAG_SOLID | TILE_FLAG_BREAKABLE },
+
+    { TILE_WATER,             TILE_FLAG_LIQUID },
+    { TILE_LAVA,              TILE_FLAG_LIQUID | TILE_FLAG_LIGHT }
 };
 
-inline const std::vector<int> TILE_CATEGORY_PLANTS = {
-    TILE_FLOWER_RED, TILE_FLOWER_YELLOW, TILE_MUSHROOM_RED, TILE_MUSHROOM_BROWN, TILE_PUMPKIN, TILE_MELON
-};
+// Flags indexed by tile id + 1 (so TILE_AIR lands on slot 0), built at compile time from TILE_INFO
+inline constexpr std::array<std::uint16_t, TILE_COUNT + 1> TILE_PROPERTIES = [] {
+    std::array<std::uint16_t, TILE_COUNT + 1> table{};
+    for (const TileInfo& info : TILE_INFO) {
+        table[info.id + 1] |= info.flags;
+    }
+    return table;
+}();
+
+// O(1) property lookup. Ids outside the tile range (tools) have no flags.
+constexpr std::uint16_t getTileFlags(int tileId) {
+    return (tileId >= TILE_AIR && tileId < TILE_COUNT) ? TILE_PROPERTIES[tileId + 1] : std::uint16_t{ TILE_FLAG_NONE };
+}
+
+constexpr bool tileHasFlag(int tileId, std::uint16_t flag) { return (getTileFlags(tileId) & flag) != 0; }
+constexpr bool isSolidTile(int tileId) { return tileHasFlag(tileId, TILE_FLAG_SOLID); }
+constexpr bool isBreakableTile(int tileId) { return tileHasFlag(tileId, TILE_FLAG_BREAKABLE); }
+constexpr bool isLiquidTile(int tileId) { return tileHasFlag(tileId, TILE_FLAG_LIQUID); }
+
+static_assert(isSolidTile(TILE_STONE) && !isSolidTile(TILE_AIR) && !isSolidTile(TILE_WATER), "tile property table");
+static_assert(!isBreakableTile(TILE_BEDROCK) && isBreakableTile(TILE_DIRT), "tile property table");
+
+// All tiles carrying a flag, in TILE_INFO order
+inline std::vector<int> tilesWithFlag(std::uint16_t flag) {
+    std::vector<int> result;
+    for (const TileInfo& info : TILE_INFO) {
+        if (info.flags & flag) result.push_back(info.id);
+    }
+    return result;
+}
 
-inline const std::vector<int> TILE_CATEGORY_LIQUIDS = {
-    TILE_WATER, TILE_LAVA
-};
+// inline vectors you can use at runtime to check membership.
+inline const std::vector<int> TILE_CATEGORY_TERRAIN = tilesWithFlag(TILE_FLAG_TERRAIN);
+inline const std::vector<int> TILE_CATEGORY_WOOD = tilesWithFlag(TILE_FLAG_WOOD);
+inline const std::vector<int> TILE_CATEGORY_ORES = tilesWithFlag(TILE_FLAG_ORE);
+inline const std::vector<int> TILE_CATEGORY_DECORATIVE = tilesWithFlag(TILE_FLAG_DECORATIVE);
+inline const std::vector<int> TILE_CATEGORY_PLANTS = tilesWithFlag(TILE_FLAG_PLANT);
+inline const std::vector<int> TILE_CATEGORY_LIQUIDS = tilesWithFlag(TILE_FLAG_LIQUID);
 
 inline const std::vector<int> ITEM_CATEGORY_TOOLS = {
     TOOL_SWORD, TOOL_PICKAXE, TOOL_AXE, TOOL_SHOVEL
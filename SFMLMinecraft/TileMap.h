@@ -1,34 +1,49 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include "TileWorld.h"
 
 class TileMap : public sf::Drawable, public sf::Transformable {
 public:
     bool load(const std::string& tileset, // file path
         sf::Vector2u tileSize,     //  square size
-        const std::vector<int>& tiles, //holding the tile index(0 - based) for each cell in the tileset
-        unsigned int width, unsigned int height);
+        TileStorage&& tiles); //holding the tile index(0 - based) for each cell in the tileset, taken over without a copy
 
-    void setTile(unsigned int x, unsigned int y, int tileId);
-    int  getTile(unsigned int x, unsigned int y) const;
+    void setTile(unsigned int x, unsigned int y, Tile tileId) { map_world.setTile(x, y, tileId); }
+    Tile getTile(unsigned int x, unsigned int y) const { return map_world.getTile(x, y); }
 
+    // Batched edits, see TileWorld
+    void setTiles(const std::vector<TileEdit>& edits) { map_world.setTiles(edits); }
+    void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, Tile tile) {
+        map_world.fillRect(x, y, width, height, tile);
+    }
+    void setSpan(unsigned int x, unsigned int y, const Tile* tiles, unsigned int count) { map_world.setSpan(x, y, tiles, count); }
+    void setRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const Tile* tiles) {
+        map_world.setRect(x, y, width, height, tiles);
+    }
 
-    unsigned int getWidth() const { return map_width; }
-    unsigned int getHeight() const { return map_height; }
+
+    unsigned int getWidth() const { return map_world.getWidth(); }
+    unsigned int getHeight() const { return map_world.getHeight(); }
     sf::Vector2u getTileSize() const { return map_tileSize; }
-    const std::vector<int>& getTiles() const { return map_tiles; }
+    const TileStorage& getTiles() const { return map_world.getTiles(); }
+    int getSurfaceY(unsigned int x) const { return map_world.getSurfaceY(x); } // topmost grass row, -1 if none
 
     const sf::Texture& getTileSet() const { return map_tileset; }
 
+    // Every change since the last drain, one bounding box per changed chunk; draining resets the set
+    void drainDirtyRegions(std::vector<DirtyRegion>& out) { map_world.drainDirtyRegions(out); }
+    bool hasDirtyRegions() const { return map_world.hasDirtyRegions(); }
+
+    // Background simulation: setTile posts edits to it, and applySimulationChanges pulls in what
+    // it published. Call applySimulationChanges once per frame before drawing.
+    void setSimulationThread(WorldSimulationThread* simulation) { map_world.setSimulationThread(simulation); }
+    void applySimulationChanges() { map_world.applySimulationChanges(); }
+
 
 private:
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
-    void updateTileVertices(unsigned int x, unsigned int y);
-
-    sf::VertexArray         map_vertices;
+    TileWorld               map_world; // tiles, chunk meshes, dirty regions and simulation hookup
     sf::Texture             map_tileset;
-    std::vector<int>        map_tiles;
-    unsigned int            map_width = 0;
-    unsigned int            map_height = 0;
     sf::Vector2u            map_tileSize;
 };
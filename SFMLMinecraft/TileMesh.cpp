@@ -0,0 +1,163 @@
+﻿#include "TileMesh.h"
+#include "TileID.h"
+#include <algorithm>
+
+void TileMesh::rebuild(const TileStorage& tiles, sf::Vector2u tileSize, unsigned int tilesetColumns)
+{
+    mesh_tileSize = tileSize;
+    mesh_tilesetColumns = std::max(1u, tilesetColumns);
+    mesh_chunksX = tiles.getChunksX();
+
+    mesh_chunks.clear();
+    mesh_chunks.resize(static_cast<std::size_t>(tiles.getChunksX()) * tiles.getChunksY());
+
+    for (unsigned int cy = 0; cy < tiles.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < tiles.getChunksX(); ++cx) {
+            if (tiles.getChunk(cx, cy)) {
+                buildChunk(tiles, cx, cy);
+            }
+        }
+    }
+}
+
+void TileMesh::onTileChanged(const TileStorage& tiles, unsigned int x, unsigned int y)
+{
+    unsigned int cx = x >> CHUNK_SHIFT;
+    unsigned int cy = y >> CHUNK_SHIFT;
+    if (!tiles.getChunk(cx, cy)) return;
+
+    if (mesh_chunks[cx + cy * mesh_chunksX].empty()) {
+        // First write into an empty chunk: mesh the whole chunk once
+        buildChunk(tiles, cx, cy);
+    }
+    else {
+        updateTile(tiles, x, y);
+    }
+}
+
+void TileMesh::markTileChanged(unsigned int x, unsigned int y)
+{
+    if (mesh_pending.size() != mesh_chunks.size() * CHUNK_SIZE) {
+        mesh_pending.assign(mesh_chunks.size() * CHUNK_SIZE, 0);
+    }
+
+    // One bit per tile, one word per chunk row, so a tile marked several times is meshed once
+    const std::size_t row = ((x >> CHUNK_SHIFT) + (y >> CHUNK_SHIFT) * mesh_chunksX) * static_cast<std::size_t>(CHUNK_SIZE) + (y & CHUNK_MASK);
+    if (mesh_pending[row] == 0) mesh_pendingRows.push_back(row);
+    mesh_pending[row] |= std::uint64_t{ 1 } << (x & CHUNK_MASK);
+}
+
+void TileMesh::updateMarkedTiles(const TileStorage& tiles)
+{
+    for (std::size_t row : mesh_pendingRows) {
+        std::uint64_t bits = mesh_pending[row];
+        if (bits == 0) continue; // chunk already meshed whole below
+        mesh_pending[row] = 0;
+
+        const unsigned int chunk = static_cast<unsigned int>(row >> CHUNK_SHIFT);
+        const unsigned int cx = chunk % mesh_chunksX;
+        const unsigned int cy = chunk / mesh_chunksX;
+        const unsigned int ly = static_cast<unsigned int>(row & CHUNK_MASK);
+        const Chunk* tileChunk = tiles.getChunk(cx, cy);
+        if (!tileChunk) continue; // only air was written into an empty chunk
+
+        std::vector<sf::Vertex>& vertices = mesh_chunks[chunk];
+        if (vertices.empty()) {
+            // First content in this chunk: mesh it whole, which covers its other marked rows too
+            buildChunk(tiles, cx, cy);
+            std::fill_n(&mesh_pending[static_cast<std::size_t>(chunk) * CHUNK_SIZE], CHUNK_SIZE, std::uint64_t{ 0 });
+            continue;
+        }
+
+        // Walk the marked tiles of this chunk row straight from the chunk, no per-tile lookups
+        const Tile* tileRow = tileChunk->row(ly);
+        sf::Vertex* quads = &vertices[static_cast<std::size_t>(ly << CHUNK_SHIFT) * 6];
+        const unsigned int y = (cy << CHUNK_SHIFT) + ly;
+        while (bits) {
+            const unsigned int lx = lowestSetBit(bits);
+            bits &= bits - 1;
+            writeQuad(quads + lx * 6, (cx << CHUNK_SHIFT) + lx, y, tileRow[lx]);
+        }
+    }
+    mesh_pendingRows.clear();
+}
+
+void TileMesh::buildChunk(const TileStorage& tiles, unsigned int cx, unsigned int cy)
+{
+    std::vector<sf::Vertex>& vertices = mesh_chunks[cx + cy * mesh_chunksX];
+    vertices.assign(static_cast<std::size_t>(CHUNK_SIZE) * CHUNK_SIZE * 6, sf::Vertex{});
+
+    unsigned int endX = std::min((cx + 1) * CHUNK_SIZE, tiles.getWidth());
+    unsigned int endY = std::min((cy + 1) * CHUNK_SIZE, tiles.getHeight());
+    for (unsigned int j = cy * CHUNK_SIZE; j < endY; ++j) {
+        for (unsigned int i = cx * CHUNK_SIZE; i < endX; ++i) {
+            updateTile(tiles, i, j);
+        }
+    }
+}
+
+void TileMesh::updateTile(const TileStorage& tiles, unsigned int i, unsigned int j)
+{
+    // Get the chunk mesh and the vertex index inside it
+    std::vector<sf::Vertex>& vertices = mesh_chunks[(i >> CHUNK_SHIFT) + (j >> CHUNK_SHIFT) * mesh_chunksX];
+    if (vertices.empty()) return; // chunk not meshed yet
+    int vertexIndex = ((i & CHUNK_MASK) + ((j & CHUNK_MASK) << CHUNK_SHIFT)) * 6;
+
+    writeQuad(&vertices[vertexIndex], i, j, tiles.getTile(i, j));
+}
+
+void TileMesh::writeQuad(sf::Vertex* vertices, unsigned int i, unsigned int j, int tileNumber) const
+{
+    // Air tile - make completely transparent
+    if (tileNumber == TILE_AIR) {
+        for (int k = 0; k < 6; ++k) {
+            vertices[k].color = sf::Color(0, 0, 0, 0);
+            vertices[k].texCoords = sf::Vector2f(0.f, 0.f);
+        }
+        return;
+    }
+
+    int tu = tileNumber % mesh_tilesetColumns;
+    int tv = tileNumber / mesh_tilesetColumns;
+
+    // Adjust vertex position and texture coordinate 
+    float left = static_cast<float>(i * mesh_tileSize.x);
+    float right = left + static_cast<float>(mesh_tileSize.x);
+    float top = static_cast<float>(j * mesh_tileSize.y);
+    float bottom = top + static_cast<float>(mesh_tileSize.y);
+
+    float texLeft = static_cast<float>(tu * mesh_tileSize.x);
+    float texRight = texLeft + static_cast<float>(mesh_tileSize.x);
+    float texTop = static_cast<float>(tv * mesh_tileSize.y);
+    float texBottom = texTop + static_cast<float>(mesh_tileSize.y);
+
+    // Texture koordinatlarını 0.5 piksel içeri alarak kenar sorunlarını önle
+    float texturePadding = 0.5f;
+    texLeft += texturePadding;
+    texRight -= texturePadding;
+    texTop += texturePadding;
+    texBottom -= texturePadding;
+
+    // First triangle
+    vertices[0].position = sf::Vector2f(left, top);
+    vertices[1].position = sf::Vector2f(right, top);
+    vertices[2].position = sf::Vector2f(left, bottom);
+
+    vertices[0].texCoords = sf::Vector2f(texLeft, texTop);
+    vertices[1].texCoords = sf::Vector2f(texRight, texTop);
+    vertices[2].texCoords = sf::Vector2f(texLeft, texBottom);
+
+    // Second triangle
+    vertices[3].position = sf::Vector2f(right, top);
+    vertices[4].position = sf::Vector2f(right, bottom);
+    vertices[5].position = sf::Vector2f(left, bottom);
+
+    vertices[3].texCoords = sf::Vector2f(texRight, texTop);
+    vertices[4].texCoords = sf::Vector2f(texRight, texBottom);
+    vertices[5].texCoords = sf::Vector2f(texLeft, texBottom);
+
+    // Set all vertex colors to white with full opacity
+    for (int k = 0; k < 6; ++k) {
+        vertices[k].color = sf::Color::White;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <vector>
+#include "TileStorage.h"
+
+// CPU-side triangle meshes for a TileStorage, one vertex list per chunk.
+// Only uses header-only SFML types, so it can be built and benchmarked without a window.
+class TileMesh {
+public:
+    // Drops all meshes and builds one for every loaded chunk
+    void rebuild(const TileStorage& tiles, sf::Vector2u tileSize, unsigned int tilesetColumns);
+
+    // Call after a tile changed: meshes the chunk the first time it gets content, otherwise patches one tile
+    void onTileChanged(const TileStorage& tiles, unsigned int x, unsigned int y);
+
+    // Batched updates: mark any number of changed tiles (repeats are fine), then updateMarkedTiles
+    // re-meshes each of them once, row by row straight from the chunks. A chunk that gets its first
+    // content is meshed once, whole.
+    void markTileChanged(unsigned int x, unsigned int y);
+    void updateMarkedTiles(const TileStorage& tiles);
+
+    void buildChunk(const TileStorage& tiles, unsigned int cx, unsigned int cy);
+    void updateTile(const TileStorage& tiles, unsigned int x, unsigned int y);
+
+    // Empty for chunks that were never loaded
+    const std::vector<sf::Vertex>& getChunkVertices(unsigned int cx, unsigned int cy) const {
+        return mesh_chunks[cx + cy * mesh_chunksX];
+    }
+
+private:
+    // The six vertices of one tile
+    void writeQuad(sf::Vertex* vertices, unsigned int i, unsigned int j, int tileNumber) const;
+
+    std::vector<std::vector<sf::Vertex>> mesh_chunks;
+    unsigned int mesh_chunksX = 0;
+    unsigned int mesh_tilesetColumns = 1;
+    sf::Vector2u mesh_tileSize;
+
+    // Marked tiles: one bit per tile, CHUNK_SIZE words per chunk, and the words that are non-zero
+    std::vector<std::uint64_t> mesh_pending;
+    std::vector<std::size_t> mesh_pendingRows;
+};
@@ -0,0 +1,87 @@
+#include "TileStorage.h"
+
+TileStorage::TileStorage(unsigned int width, unsigned int height)
+    : st_width(width), st_height(height),
+    st_chunksX((width + CHUNK_MASK) >> CHUNK_SHIFT),
+    st_chunksY((height + CHUNK_MASK) >> CHUNK_SHIFT)
+{
+    st_chunks.resize(static_cast<std::size_t>(st_chunksX) * st_chunksY);
+    st_surface.assign(width, -1);
+}
+
+TileStorage TileStorage::clone() const
+{
+    TileStorage copy(st_width, st_height);
+    for (std::size_t i = 0; i < st_chunks.size(); ++i) {
+        if (st_chunks[i]) {
+            copy.st_chunks[i] = std::make_unique<Chunk>(*st_chunks[i]);
+        }
+    }
+    copy.st_surface = st_surface;
+    return copy;
+}
+
+Tile TileStorage::getTile(unsigned int x, unsigned int y) const
+{
+    if (x >= st_width || y >= st_height) return TILE_AIR;
+
+    const Chunk* chunk = getChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    if (!chunk) return TILE_AIR;
+    return chunk->get(x & CHUNK_MASK, y & CHUNK_MASK);
+}
+
+void TileStorage::setTile(unsigned int x, unsigned int y, Tile tile)
+{
+    if (x >= st_width || y >= st_height) return;
+
+    Chunk* chunk = getChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    if (!chunk) {
+        // Writing air into a chunk that was never allocated changes nothing
+        if (tile == TILE_AIR) return;
+        chunk = &getOrCreateChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    }
+    const Tile previous = chunk->get(x & CHUNK_MASK, y & CHUNK_MASK);
+    chunk->set(x & CHUNK_MASK, y & CHUNK_MASK, tile);
+
+    // Grass above the surface raises it; removing the surface grass lowers it to the next grass
+    int& surface = st_surface[x];
+    const int row = static_cast<int>(y);
+    if (tile == TILE_GRASS) {
+        if (surface < 0 || row < surface) surface = row;
+    }
+    else if (previous == TILE_GRASS && row == surface) {
+        surface = findSurfaceBelow(x, y + 1);
+    }
+}
+
+int TileStorage::findSurfaceBelow(unsigned int x, unsigned int y) const
+{
+    // Only reached when the surface grass itself is removed, so the scan is rare
+    for (; y < st_height; ++y) {
+        const Chunk* chunk = getChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        if (!chunk) {
+            y |= CHUNK_MASK; // all air down to the next chunk
+            continue;
+        }
+        if (chunk->get(x & CHUNK_MASK, y & CHUNK_MASK) == TILE_GRASS) return static_cast<int>(y);
+    }
+    return -1;
+}
+
+Chunk& TileStorage::getOrCreateChunk(unsigned int cx, unsigned int cy)
+{
+    std::unique_ptr<Chunk>& slot = st_chunks[cx + cy * st_chunksX];
+    if (!slot) {
+        slot = std::make_unique<Chunk>();
+    }
+    return *slot;
+}
+
+std::size_t TileStorage::getLoadedChunkCount() const
+{
+    std::size_t count = 0;
+    for (const auto& chunk : st_chunks) {
+        if (chunk) ++count;
+    }
+    return count;
+}
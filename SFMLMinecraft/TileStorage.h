@@ -0,0 +1,135 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TileID.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Chunks are square and power-of-two sized so tile -> chunk lookups are shifts and masks
+constexpr unsigned int CHUNK_SHIFT = 6;
+constexpr unsigned int CHUNK_SIZE = 1u << CHUNK_SHIFT; // 64x64 tiles
+constexpr unsigned int CHUNK_MASK = CHUNK_SIZE - 1;
+
+// Index of the lowest set bit; bits must not be zero
+inline unsigned int lowestSetBit(std::uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctzll(bits));
+#endif
+}
+
+// One fixed-size block of tiles, stored row-major so horizontal neighbours are adjacent in memory.
+// Next to the tiles every row keeps a bitboard (bit lx = column lx) of its air, water and lava,
+// so the liquid passes can test 64 tiles with one mask. set() keeps them in sync; write tiles
+// only through it.
+struct Chunk {
+    std::array<Tile, CHUNK_SIZE * CHUNK_SIZE> tiles;
+    std::array<std::uint64_t, CHUNK_SIZE> air;
+    std::array<std::uint64_t, CHUNK_SIZE> water;
+    std::array<std::uint64_t, CHUNK_SIZE> lava;
+    static_assert(CHUNK_SIZE == 64, "one bitboard word per chunk row");
+
+    Chunk() {
+        tiles.fill(TILE_AIR);
+        air.fill(~std::uint64_t{ 0 });
+        water.fill(0);
+        lava.fill(0);
+    }
+
+    Tile get(unsigned int lx, unsigned int ly) const { return tiles[lx + (ly << CHUNK_SHIFT)]; }
+    void set(unsigned int lx, unsigned int ly, Tile tile) {
+        tiles[lx + (ly << CHUNK_SHIFT)] = tile;
+        const std::uint64_t bit = std::uint64_t{ 1 } << lx;
+        air[ly] = (tile == TILE_AIR) ? (air[ly] | bit) : (air[ly] & ~bit);
+        water[ly] = (tile == TILE_WATER) ? (water[ly] | bit) : (water[ly] & ~bit);
+        lava[ly] = (tile == TILE_LAVA) ? (lava[ly] | bit) : (lava[ly] & ~bit);
+    }
+    const Tile* row(unsigned int ly) const { return tiles.data() + (ly << CHUNK_SHIFT); }
+
+    // Replaces all tiles (row-major, CHUNK_SIZE * CHUNK_SIZE of them) and rebuilds the bitboards
+    void assign(const Tile* source) {
+        for (unsigned int ly = 0; ly < CHUNK_SIZE; ++ly) {
+            std::uint64_t airBits = 0, waterBits = 0, lavaBits = 0;
+            const Tile* in = source + (ly << CHUNK_SHIFT);
+            for (unsigned int lx = 0; lx < CHUNK_SIZE; ++lx) {
+                tiles[lx + (ly << CHUNK_SHIFT)] = in[lx];
+                airBits |= std::uint64_t{ in[lx] == TILE_AIR } << lx;
+                waterBits |= std::uint64_t{ in[lx] == TILE_WATER } << lx;
+                lavaBits |= std::uint64_t{ in[lx] == TILE_LAVA } << lx;
+            }
+            air[ly] = airBits;
+            water[ly] = waterBits;
+            lava[ly] = lavaBits;
+        }
+    }
+};
+
+// One tile write, for edit lists handed between systems
+struct TileEdit {
+    unsigned int x;
+    unsigned int y;
+    Tile tile;
+};
+
+// World tiles split into chunks. Chunks are only allocated once something other than air
+// is written into them, so memory scales with the chunks in use instead of the whole map.
+// The storage is move-only: generation builds it and hands it to its single owner (TileMap).
+// Not synchronised. Writes that land in different chunk columns may run on different threads.
+//
+// Next to the chunks it keeps the surface of every column: the row of its topmost grass tile.
+// setTile keeps it current, so surface lookups are O(1) instead of a scan down the column. The
+// surface is shared by every chunk of a column, and removing the surface grass scans the column's
+// other chunks, so chunks of one column may only be written concurrently by writes that neither
+// place nor remove grass (the liquid passes, which only move liquid through air).
+class TileStorage {
+public:
+    TileStorage() = default;
+    TileStorage(unsigned int width, unsigned int height);
+
+    TileStorage(TileStorage&&) = default;
+    TileStorage& operator=(TileStorage&&) = default;
+    TileStorage(const TileStorage&) = delete;
+    TileStorage& operator=(const TileStorage&) = delete;
+
+    // Explicit deep copy, for the rare places that really need a second world
+    TileStorage clone() const;
+
+    Tile getTile(unsigned int x, unsigned int y) const;
+    void setTile(unsigned int x, unsigned int y, Tile tile);
+
+    unsigned int getWidth() const { return st_width; }
+    unsigned int getHeight() const { return st_height; }
+    unsigned int getChunksX() const { return st_chunksX; }
+    unsigned int getChunksY() const { return st_chunksY; }
+
+    // nullptr when the chunk has never been written (all air)
+    const Chunk* getChunk(unsigned int cx, unsigned int cy) const { return st_chunks[cx + cy * st_chunksX].get(); }
+    Chunk*       getChunk(unsigned int cx, unsigned int cy) { return st_chunks[cx + cy * st_chunksX].get(); }
+    Chunk&       getOrCreateChunk(unsigned int cx, unsigned int cy);
+
+    std::size_t getLoadedChunkCount() const;
+
+    // Row of the topmost grass tile in column x, or -1 when the column has none
+    int getSurfaceY(unsigned int x) const { return x < st_width ? st_surface[x] : -1; }
+    // For generators that write grass straight into chunks (Chunk::set bypasses the surface).
+    // Each column has its own entry, so different chunk columns may be set from different threads;
+    // one column never from two at once.
+    void setSurfaceY(unsigned int x, int y) { if (x < st_width) st_surface[x] = y; }
+
+private:
+    int findSurfaceBelow(unsigned int x, unsigned int y) const;
+
+    std::vector<std::unique_ptr<Chunk>> st_chunks; // chunk index, row-major over chunk coordinates
+    std::vector<int> st_surface;                   // per column, see getSurfaceY
+    unsigned int st_width = 0;
+    unsigned int st_height = 0;
+    unsigned int st_chunksX = 0;
+    unsigned int st_chunksY = 0;
+};
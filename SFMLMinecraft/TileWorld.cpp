@@ -0,0 +1,113 @@
+#include "TileWorld.h"
+#include <algorithm>
+
+void TileWorld::load(TileStorage&& tiles, sf::Vector2u tileSize, unsigned int tilesetColumns)
+{
+    world_tiles = std::move(tiles);
+
+    // One triangle mesh per chunk so only loaded chunks cost vertices
+    world_mesh.rebuild(world_tiles, tileSize, tilesetColumns);
+    world_dirty.resize(world_tiles.getChunksX(), world_tiles.getChunksY());
+}
+
+void TileWorld::setTile(unsigned int x, unsigned int y, Tile tile)
+{
+    if (x < world_tiles.getWidth() && y < world_tiles.getHeight()) {
+        world_tiles.setTile(x, y, tile);
+        world_mesh.onTileChanged(world_tiles, x, y);
+        world_dirty.markTile(x, y);
+        if (world_simulation) world_simulation->postEdit(x, y, tile);
+    }
+}
+
+void TileWorld::setTiles(const std::vector<TileEdit>& edits)
+{
+    for (const TileEdit& edit : edits) {
+        writeTile(edit.x, edit.y, edit.tile);
+    }
+    flushBatch(true);
+}
+
+void TileWorld::fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, Tile tile)
+{
+    if (x >= world_tiles.getWidth() || y >= world_tiles.getHeight()) return;
+
+    const unsigned int endX = x + std::min(width, world_tiles.getWidth() - x);
+    const unsigned int endY = y + std::min(height, world_tiles.getHeight() - y);
+    bool changed = false;
+    for (unsigned int j = y; j < endY; ++j) {
+        for (unsigned int i = x; i < endX; ++i) {
+            changed |= storeTile(i, j, tile);
+        }
+    }
+    // One box per chunk for the whole rectangle instead of growing it tile by tile
+    if (changed) world_dirty.markRect(x, y, endX - x, endY - y);
+    flushBatch(true);
+}
+
+void TileWorld::setSpan(unsigned int x, unsigned int y, const Tile* tiles, unsigned int count)
+{
+    if (x >= world_tiles.getWidth() || y >= world_tiles.getHeight()) return;
+
+    const unsigned int end = std::min(world_tiles.getWidth() - x, count);
+    for (unsigned int k = 0; k < end; ++k) {
+        writeTile(x + k, y, tiles[k]);
+    }
+    flushBatch(true);
+}
+
+void TileWorld::setRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const Tile* tiles)
+{
+    if (x >= world_tiles.getWidth() || y >= world_tiles.getHeight()) return;
+
+    const unsigned int columns = std::min(width, world_tiles.getWidth() - x);
+    const unsigned int rows = std::min(height, world_tiles.getHeight() - y);
+    bool changed = false;
+    for (unsigned int j = 0; j < rows; ++j) {
+        const Tile* row = tiles + static_cast<std::size_t>(j) * width;
+        for (unsigned int i = 0; i < columns; ++i) {
+            changed |= storeTile(x + i, y + j, row[i]);
+        }
+    }
+    if (changed) world_dirty.markRect(x, y, columns, rows);
+    flushBatch(true);
+}
+
+void TileWorld::writeTile(unsigned int x, unsigned int y, Tile tile)
+{
+    if (storeTile(x, y, tile)) world_dirty.markTile(x, y);
+}
+
+bool TileWorld::storeTile(unsigned int x, unsigned int y, Tile tile)
+{
+    if (x >= world_tiles.getWidth() || y >= world_tiles.getHeight()) return false;
+    if (world_tiles.getTile(x, y) == tile) return false;
+
+    world_tiles.setTile(x, y, tile);
+    world_mesh.markTileChanged(x, y);
+    world_batchEdits.push_back({ x, y, tile });
+    return true;
+}
+
+void TileWorld::flushBatch(bool fromGame)
+{
+    world_mesh.updateMarkedTiles(world_tiles);
+
+    if (fromGame && !world_batchEdits.empty()) {
+        // One lock for the whole batch; edits stay in order, so a cell written twice ends up right
+        if (world_simulation) world_simulation->postEdits(world_batchEdits);
+    }
+    world_batchEdits.clear();
+}
+
+void TileWorld::applySimulationChanges()
+{
+    if (!world_simulation) return;
+
+    world_simulation->takeChanges(world_simulationChanges);
+    for (const TileEdit& edit : world_simulationChanges) {
+        writeTile(edit.x, edit.y, edit.tile);
+    }
+    // These came from the simulation, so they must not be posted back to it
+    flushBatch(false);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include "DirtyRegionTracker.h"
+#include "TileMesh.h"
+#include "TileStorage.h"
+#include "WorldSimulationThread.h"
+
+// The game's tiles with everything that has to follow an edit: the chunk meshes, the dirty
+// regions and the background simulation. No texture and no window, so it builds and is tested
+// headless; TileMap draws its mesh.
+class TileWorld {
+public:
+    // Takes the tiles over without a copy and meshes every loaded chunk
+    void load(TileStorage&& tiles, sf::Vector2u tileSize, unsigned int tilesetColumns);
+
+    void setTile(unsigned int x, unsigned int y, Tile tileId);
+    Tile getTile(unsigned int x, unsigned int y) const { return world_tiles.getTile(x, y); }
+
+    // Batched edits: all tiles are written first, writes that change nothing are dropped, and then
+    // every touched chunk's vertices are refreshed once. Out-of-map parts are clipped.
+    void setTiles(const std::vector<TileEdit>& edits); // a cell edited twice keeps the last value
+    void fillRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, Tile tile);
+    void setSpan(unsigned int x, unsigned int y, const Tile* tiles, unsigned int count); // left to right
+    void setRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height, const Tile* tiles); // row-major
+
+    unsigned int getWidth() const { return world_tiles.getWidth(); }
+    unsigned int getHeight() const { return world_tiles.getHeight(); }
+    const TileStorage& getTiles() const { return world_tiles; }
+    int getSurfaceY(unsigned int x) const { return world_tiles.getSurfaceY(x); } // topmost grass row, -1 if none
+    const TileMesh& getMesh() const { return world_mesh; }
+
+    // Every change since the last drain, from setTile, the batch edits and the simulation thread
+    // alike: one bounding box per changed chunk. fillRect and setRect mark their whole rectangle
+    // once any tile in it changed. Draining resets the set.
+    void drainDirtyRegions(std::vector<DirtyRegion>& out) { world_dirty.drain(out); }
+    bool hasDirtyRegions() const { return !world_dirty.empty(); }
+
+    // Background simulation: edits are posted to it, and applySimulationChanges pulls in what it
+    // published
+    void setSimulationThread(WorldSimulationThread* simulation) { world_simulation = simulation; }
+    void applySimulationChanges();
+
+private:
+    // Batch helpers: writeTile writes and records a tile if it changes, flushBatch refreshes the
+    // marked vertices (and, for edits made by the game, tells the simulation). storeTile is
+    // writeTile without the dirty mark, for callers that mark a whole area at once; it returns
+    // whether the tile changed.
+    void writeTile(unsigned int x, unsigned int y, Tile tile);
+    bool storeTile(unsigned int x, unsigned int y, Tile tile);
+    void flushBatch(bool fromGame);
+
+    TileMesh                world_mesh; // one vertex list per chunk, empty for unloaded chunks
+    TileStorage             world_tiles;
+    WorldSimulationThread*  world_simulation = nullptr;
+    std::vector<TileEdit>   world_simulationChanges; // reused every frame
+    std::vector<TileEdit>   world_batchEdits;        // tiles changed by the current batch
+    DirtyRegionTracker      world_dirty;
+};
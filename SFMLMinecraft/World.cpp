@@ -1,397 +1,983 @@
 #include "World.h"
-#include "TileMap.h"
+#include "LiquidSimulator.h"
+#include "ThreadPool.h"
 #include "TileID.h"
-
-
-bool rectIntersects(const sf::FloatRect& rect1, const sf::FloatRect& rect2) {
-    return !(rect1.position.x > rect2.position.x + rect2.size.x ||
-        rect1.position.x + rect1.size.x < rect2.position.x ||
-        rect1.position.y > rect2.position.y + rect2.size.y ||
-        rect1.position.y + rect1.size.y < rect2.position.y);
-}
-
-// Random number generator
-int randomInt(int min, int max) {
-    return min + std::rand() % (max - min + 1);
+#include "WorldNoise.h"
+#include "WorldPipeline.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Tile columns [left, right) and rows [top, bottom) a generation step may write to
+struct TileBounds {
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    bool contains(int x, int y) const { return x >= left && x < right && y >= top && y < bottom; }
+};
+
+TileBounds getChunkBounds(const TileStorage& tiles, unsigned int cx, unsigned int cy) {
+    const int left = static_cast<int>(cx << CHUNK_SHIFT);
+    const int top = static_cast<int>(cy << CHUNK_SHIFT);
+    return { left, top, std::min(left + static_cast<int>(CHUNK_SIZE), static_cast<int>(tiles.getWidth())),
+        std::min(top + static_cast<int>(CHUNK_SIZE), static_cast<int>(tiles.getHeight())) };
 }
 
-void generateWaterPool(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size) {
-    for (int x = centerX - size; x <= centerX + size; ++x) {
-        for (int y = centerY; y <= centerY + size; ++y) {
-            if (x >= 0 && x < static_cast<int>(width) && y >= 0 && y < static_cast<int>(height)) {
-                float distance = std::sqrt(std::pow(x - centerX, 2) + std::pow(y - centerY, 2));
-                if (distance < size) {
-                    int currentTile = tiles[x + y * width];
-                    if (currentTile == TILE_LAVA) {
-                        tiles[x + y * width] = TILE_OBSIDIAN;
-                    }
-                    else {
-                        tiles[x + y * width] = TILE_WATER;
-                    }
-                }
+void carveCave(TileStorage& tiles, int centerX, int centerY, int size, const TileBounds& bounds) {
+    const int left = std::max(centerX - size, bounds.left);
+    const int right = std::min(centerX + size, bounds.right - 1);
+    const int top = std::max(centerY - size / 2, bounds.top);
+    const int bottom = std::min(centerY + size / 2, bounds.bottom - 1);
+    for (int x = left; x <= right; ++x) {
+        for (int y = top; y <= bottom; ++y) {
+            float distance = std::sqrt(std::pow(x - centerX, 2) + std::pow(y - centerY, 2) * 1.5f);
+            if (distance < size) {
+                tiles.setTile(x, y, TILE_AIR);
             }
         }
     }
 }
 
-void generateLavaPool(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size) {
-    for (int x = centerX - size; x <= centerX + size; ++x) {
-        for (int y = centerY; y <= centerY + size; ++y) {
-            if (x >= 0 && x < static_cast<int>(width) && y >= 0 && y < static_cast<int>(height)) {
-                float distance = std::sqrt(std::pow(x - centerX, 2) + std::pow(y - centerY, 2));
-                if (distance < size) {
-                    int currentTile = tiles[x + y * width];
-                    if (currentTile == TILE_WATER) {
-                        tiles[x + y * width] = TILE_OBSIDIAN;
-                    }
-                    else {
-                        tiles[x + y * width] = TILE_LAVA;
-                    }
+// A half disc of liquid hanging down from its centre row. Where water meets lava the tile
+// becomes obsidian, so pools written one after the other end the same in every chunk.
+void fillPool(TileStorage& tiles, int centerX, int centerY, int size, Tile liquid, const TileBounds& bounds) {
+    const Tile other = liquid == TILE_LAVA ? TILE_WATER : TILE_LAVA;
+    const int left = std::max(centerX - size, bounds.left);
+    const int right = std::min(centerX + size, bounds.right - 1);
+    const int top = std::max(centerY, bounds.top);
+    const int bottom = std::min(centerY + size, bounds.bottom - 1);
+    for (int x = left; x <= right; ++x) {
+        for (int y = top; y <= bottom; ++y) {
+            float distance = std::sqrt(std::pow(x - centerX, 2) + std::pow(y - centerY, 2));
+            if (distance < size) {
+                if (tiles.getTile(x, y) == other) {
+                    tiles.setTile(x, y, TILE_OBSIDIAN);
+                }
+                else {
+                    tiles.setTile(x, y, liquid);
                 }
             }
         }
     }
 }
 
-void generateUndergroundCave(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size) {
-    for (int x = centerX - size; x <= centerX + size; ++x) {
-        for (int y = centerY - size / 2; y <= centerY + size / 2; ++y) {
-            if (x >= 0 && x < static_cast<int>(width) && y >= 0 && y < static_cast<int>(height)) {
-                float distance = std::sqrt(std::pow(x - centerX, 2) + std::pow(y - centerY, 2) * 1.5f);
-                if (distance < size) {
-                    tiles[x + y * width] = TILE_AIR;
-                }
-            }
+TileBounds getWorldBounds(const TileStorage& tiles) {
+    return { 0, 0, static_cast<int>(tiles.getWidth()), static_cast<int>(tiles.getHeight()) };
+}
+
+} // namespace
+
+void generateWaterPool(TileStorage& tiles, int centerX, int centerY, int size) {
+    fillPool(tiles, centerX, centerY, size, TILE_WATER, getWorldBounds(tiles));
+}
+
+void generateLavaPool(TileStorage& tiles, int centerX, int centerY, int size) {
+    fillPool(tiles, centerX, centerY, size, TILE_LAVA, getWorldBounds(tiles));
+}
+
+void generateUndergroundCave(TileStorage& tiles, int centerX, int centerY, int size) {
+    carveCave(tiles, centerX, centerY, size, getWorldBounds(tiles));
+}
+
+namespace {
+
+// Liquid passes write straight into the world, but every decision has to see the tiles as they
+// were when the pass started. A pass at row y only reads rows y and y + 1, so keeping those two
+// rows from before the pass is all the double buffering needed. Rows are kept as bitboards
+// (bit x & 63 of word x >> 6), so a snapshot is three words per chunk instead of 64 tiles.
+struct RowBits {
+    std::vector<std::uint64_t> air;
+    std::vector<std::uint64_t> water;
+    std::vector<std::uint64_t> lava;
+
+    void resize(std::size_t words) {
+        air.resize(words);
+        water.resize(words);
+        lava.resize(words);
+    }
+};
+
+// Reused between calls so a tick never allocates or copies the world
+struct LiquidRows {
+    RowBits current;
+    RowBits below;
+    // Extra rows for the fused updateWorld sweep
+    RowBits lavaCurrent;
+    RowBits lavaBelow;
+    RowBits settledAbove;
+    RowBits settled;
+    RowBits settledBelow;
+
+    void resize(std::size_t words) {
+        for (RowBits* row : { &current, &below, &lavaCurrent, &lavaBelow, &settledAbove, &settled, &settledBelow }) {
+            row->resize(words);
+        }
+    }
+};
+thread_local LiquidRows liquidRows;
+
+// A world row is one word per chunk column, so the bitboards come straight from the chunks
+void copyRowBits(const TileStorage& tiles, unsigned int y, RowBits& out) {
+    const unsigned int width = tiles.getWidth();
+    const unsigned int cy = y >> CHUNK_SHIFT;
+    const unsigned int ly = y & CHUNK_MASK;
+    for (unsigned int cx = 0; cx < tiles.getChunksX(); ++cx) {
+        // Columns past the right edge of the world must never read as air
+        const unsigned int count = std::min(CHUNK_SIZE, width - (cx << CHUNK_SHIFT));
+        const std::uint64_t inside = count == CHUNK_SIZE ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << count) - 1;
+        const Chunk* chunk = tiles.getChunk(cx, cy);
+        if (chunk) {
+            out.air[cx] = chunk->air[ly] & inside;
+            out.water[cx] = chunk->water[ly];
+            out.lava[cx] = chunk->lava[ly];
+        }
+        else {
+            out.air[cx] = inside;
+            out.water[cx] = 0;
+            out.lava[cx] = 0;
         }
     }
 }
 
-void simulateWaterFlow(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    std::vector<int> newTiles = tiles; 
+// Bit x set where column x - 1 / x + 1 is set in bits, carrying across word boundaries
+std::uint64_t fromLeft(const std::vector<std::uint64_t>& bits, std::size_t w) {
+    return (bits[w] << 1) | (w > 0 ? bits[w - 1] >> 63 : 0);
+}
 
-    for (int y = height - 1; y >= 0; --y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            int index = x + y * width;
-
-            if (tiles[index] == TILE_WATER) {
-                if (y < height - 1) {
-                    int belowIndex = x + (y + 1) * width;
-                    if (tiles[belowIndex] == TILE_AIR) {
-                        newTiles[belowIndex] = TILE_WATER;
-                        newTiles[index] = TILE_AIR;
-                        continue;
-                    }
-                }
+std::uint64_t fromRight(const std::vector<std::uint64_t>& bits, std::size_t w) {
+    return (bits[w] >> 1) | (w + 1 < bits.size() ? bits[w + 1] << 63 : 0);
+}
 
-                bool canFlowLeft = (x > 0) && (tiles[x - 1 + y * width] == TILE_AIR);
-                bool canFlowRight = (x < width - 1) && (tiles[x + 1 + y * width] == TILE_AIR);
-
-                if (canFlowLeft && canFlowRight) {
-                    if (randomInt(0, 1) == 0) {
-                        newTiles[x - 1 + y * width] = TILE_WATER;
-                    }
-                    else {
-                        newTiles[x + 1 + y * width] = TILE_WATER;
-                    }
-                    newTiles[index] = TILE_AIR;
+// One row of a liquid pass. current/below are rows y and y + 1 as they were before the pass.
+// Liquid falls straight down when it can, otherwise spreads sideways into air; lava only spreads
+// on one tick in three. With spills set, falls into row y + 1 are recorded there instead of written.
+void flowRow(TileStorage& tiles, Tile liquid, int y, const RowBits& current, const RowBits* below,
+    WorldSeed seed, std::uint32_t tick, std::vector<unsigned int>* spills = nullptr) {
+    const bool lava = liquid == TILE_LAVA;
+    const RandomPurpose sidePurpose = lava ? RandomPurpose::LavaFlow : RandomPurpose::WaterFlow;
+    const std::vector<std::uint64_t>& liquidBits = lava ? current.lava : current.water;
+
+    for (std::size_t w = 0; w < liquidBits.size(); ++w) {
+        if (!liquidBits[w]) continue;
+
+        // Only liquid with air below or beside it can move; visit just those cells, left to right
+        const std::uint64_t airBelow = below ? below->air[w] : 0;
+        const std::uint64_t airLeft = fromLeft(current.air, w);
+        const std::uint64_t airRight = fromRight(current.air, w);
+        for (std::uint64_t movers = liquidBits[w] & (airBelow | airLeft | airRight); movers; movers &= movers - 1) {
+            const unsigned int bit = lowestSetBit(movers);
+            const std::uint64_t mask = std::uint64_t{ 1 } << bit;
+            const unsigned int x = static_cast<unsigned int>(w << 6) + bit;
+
+            if (airBelow & mask) {
+                if (spills) {
+                    spills->push_back(x);
                 }
-                else if (canFlowLeft) {
-                    newTiles[x - 1 + y * width] = TILE_WATER;
-                    newTiles[index] = TILE_AIR;
+                else {
+                    tiles.setTile(x, y + 1, liquid);
                 }
-                else if (canFlowRight) {
-                    newTiles[x + 1 + y * width] = TILE_WATER;
-                    newTiles[index] = TILE_AIR;
+                tiles.setTile(x, y, TILE_AIR);
+                continue;
+            }
+
+            if (lava && randomInt({ seed, static_cast<int>(x), y, RandomPurpose::LavaSpread, tick }, 0, 2) != 0) {
+                continue;
+            }
+
+            const bool canFlowLeft = (airLeft & mask) != 0;
+            const bool canFlowRight = (airRight & mask) != 0;
+            if (canFlowLeft && canFlowRight) {
+                if (randomInt({ seed, static_cast<int>(x), y, sidePurpose, tick }, 0, 1) == 0) {
+                    tiles.setTile(x - 1, y, liquid);
+                }
+                else {
+                    tiles.setTile(x + 1, y, liquid);
                 }
             }
+            else if (canFlowLeft) {
+                tiles.setTile(x - 1, y, liquid);
+            }
+            else {
+                tiles.setTile(x + 1, y, liquid);
+            }
+            tiles.setTile(x, y, TILE_AIR);
         }
     }
+}
 
-    tiles = newTiles;
+// Runs a liquid pass over rows [top, bottom]. boundary is row bottom + 1 as it was before the
+// pass (nullptr at the bottom of the world); falls into it go to spills when those are given.
+void flowRows(TileStorage& tiles, Tile liquid, int top, int bottom, const RowBits* boundary,
+    std::vector<unsigned int>* spills, WorldSeed seed, std::uint32_t tick) {
+    LiquidRows& rows = liquidRows;
+    rows.resize(tiles.getChunksX());
+
+    for (int y = bottom; y >= top; --y) {
+        // Last iteration's row is the row below, saved before anything in this pass wrote to it
+        std::swap(rows.current, rows.below);
+        copyRowBits(tiles, y, rows.current);
+        const bool edge = y == bottom;
+        flowRow(tiles, liquid, y, rows.current, edge ? boundary : &rows.below, seed, tick, edge ? spills : nullptr);
+    }
 }
 
-void simulateLavaFlow(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    std::vector<int> newTiles = tiles; 
+// Threaded passes split the world into strips of one chunk row each
+struct LiquidStrip {
+    RowBits boundary;                  // first row of the next strip, before the pass
+    std::vector<unsigned int> spills;  // columns where liquid fell into that row
+};
+thread_local std::vector<LiquidStrip> liquidStrips;
+
+void flowLiquid(TileStorage& tiles, Tile liquid, WorldSeed seed, std::uint32_t tick, ThreadPool* pool) {
+    const int height = static_cast<int>(tiles.getHeight());
+    const unsigned int strips = tiles.getChunksY();
+    if (!pool || pool->getThreadCount() < 2 || strips < 2) {
+        flowRows(tiles, liquid, 0, height - 1, nullptr, nullptr, seed, tick);
+        return;
+    }
 
-    for (int y = height - 1; y >= 0; --y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            int index = x + y * width;
-
-            if (tiles[index] == TILE_LAVA) {
-                if (y < height - 1) {
-                    int belowIndex = x + (y + 1) * width;
-                    if (tiles[belowIndex] == TILE_AIR) {
-                        newTiles[belowIndex] = TILE_LAVA;
-                        newTiles[index] = TILE_AIR;
-                        continue;
-                    }
-                }
+    // A strip reads one row past its bottom edge and may drop liquid into it. Taking that row
+    // before any strip runs and holding back the falls means no two strips ever touch the same
+    // row or chunk, so they all run at once.
+    std::vector<LiquidStrip>& stripData = liquidStrips;
+    stripData.resize(strips);
+    for (unsigned int s = 0; s + 1 < strips; ++s) {
+        stripData[s].boundary.resize(tiles.getChunksX());
+        copyRowBits(tiles, (s + 1) << CHUNK_SHIFT, stripData[s].boundary);
+        stripData[s].spills.clear();
+    }
 
-                if (randomInt(0, 2) == 0) { 
-                    bool canFlowLeft = (x > 0) && (tiles[x - 1 + y * width] == TILE_AIR);
-                    bool canFlowRight = (x < width - 1) && (tiles[x + 1 + y * width] == TILE_AIR);
-
-                    if (canFlowLeft && canFlowRight) {
-                        if (randomInt(0, 1) == 0) {
-                            newTiles[x - 1 + y * width] = TILE_LAVA;
-                        }
-                        else {
-                            newTiles[x + 1 + y * width] = TILE_LAVA;
-                        }
-                        newTiles[index] = TILE_AIR;
-                    }
-                    else if (canFlowLeft) {
-                        newTiles[x - 1 + y * width] = TILE_LAVA;
-                        newTiles[index] = TILE_AIR;
-                    }
-                    else if (canFlowRight) {
-                        newTiles[x + 1 + y * width] = TILE_LAVA;
-                        newTiles[index] = TILE_AIR;
-                    }
-                }
-            }
+    pool->parallelFor(strips, [&](std::size_t s) {
+        const int top = static_cast<int>(s << CHUNK_SHIFT);
+        const int bottom = std::min(top + static_cast<int>(CHUNK_SIZE), height) - 1;
+        const bool last = s + 1 == strips;
+        flowRows(tiles, liquid, top, bottom, last ? nullptr : &stripData[s].boundary,
+            last ? nullptr : &stripData[s].spills, seed, tick);
+    });
+
+    // Serially the strip below runs first, so its writes to the shared row come before the falls
+    for (unsigned int s = 0; s + 1 < strips; ++s) {
+        const unsigned int y = (s + 1) << CHUNK_SHIFT;
+        for (unsigned int x : stripData[s].spills) {
+            tiles.setTile(x, y, liquid);
         }
     }
-
-    tiles = newTiles;
 }
 
-void checkLiquidInteractions(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            int index = x + y * width;
+// Lava touching water hardens into obsidian. Water never changes here, so this only needs the
+// row and its neighbours as they are after both flow passes.
+void hardenRow(TileStorage& tiles, int y, const RowBits* above, const RowBits& row, const RowBits* below) {
+    for (std::size_t w = 0; w < row.lava.size(); ++w) {
+        if (!row.lava[w]) continue;
 
-            if (tiles[index] == TILE_WATER) {
-                if (x > 0 && tiles[x - 1 + y * width] == TILE_LAVA) {
-                    tiles[x - 1 + y * width] = TILE_OBSIDIAN;
-                }
-                if (x < width - 1 && tiles[x + 1 + y * width] == TILE_LAVA) {
-                    tiles[x + 1 + y * width] = TILE_OBSIDIAN;
-                }
-                if (y > 0 && tiles[x + (y - 1) * width] == TILE_LAVA) {
-                    tiles[x + (y - 1) * width] = TILE_OBSIDIAN;
-                }
-                if (y < height - 1 && tiles[x + (y + 1) * width] == TILE_LAVA) {
-                    tiles[x + (y + 1) * width] = TILE_OBSIDIAN;
+        const std::uint64_t touchesWater = fromLeft(row.water, w) | fromRight(row.water, w)
+            | (above ? above->water[w] : 0) | (below ? below->water[w] : 0);
+        for (std::uint64_t hits = row.lava[w] & touchesWater; hits; hits &= hits - 1) {
+            tiles.setTile(static_cast<unsigned int>(w << 6) + lowestSetBit(hits), y, TILE_OBSIDIAN);
+        }
+    }
+}
+
+// Terrain noise: rolling hills, cave pockets under the dirt and ore veins in the stone
+const NoiseParams SURFACE_NOISE = { 0, RandomPurpose::SurfaceHeight, 0, 5, 3 };
+const NoiseParams CAVE_NOISE = { 0, RandomPurpose::Cave, 0, 4, 2 };
+const NoiseParams ORE_VEIN_NOISE = { 0, RandomPurpose::OreVein, 0, 2, 1 };
+const int SURFACE_AMPLITUDE = 5;
+const float CAVE_THRESHOLD = 0.45f;
+const float ORE_VEIN_THRESHOLD = 0.59f; // about 10% of the stone deep enough for ore
+
+// What a vein is made of, by depth below the surface. Rates are percent of the vein cells in the
+// band and each band runs until the next one starts; deep down it is the old 5:3:2:1 ore mix.
+// Tune here: the fill loop only looks the result up.
+struct OreBand {
+    int minDepth; // band applies deeper than this many tiles below the surface
+    std::array<std::uint8_t, 4> percent; // coal, iron, gold, diamond; sums to 100
+};
+const Tile ORE_TILES[] = { TILE_COAL_ORE, TILE_IRON_ORE, TILE_GOLD_ORE, TILE_DIAMOND_ORE };
+const OreBand ORE_BANDS[] = {
+    { 0, { 100, 0, 0, 0 } },
+    { 10, { 62, 38, 0, 0 } },
+    { 15, { 45, 27, 18, 10 } },
+};
+constexpr std::size_t ORE_BAND_COUNT = sizeof(ORE_BANDS) / sizeof(ORE_BANDS[0]);
+const int ORE_REGION_SHIFT = 3; // one ore draw per 8x8 tiles, so a vein keeps one ore per region
+
+// ORE_BANDS expanded once into a tile per (band, draw) and a band per depth, so choosing an
+// ore is one random draw and two lookups
+struct OreTable {
+    std::array<std::array<Tile, 100>, ORE_BAND_COUNT> tiles;
+    std::vector<std::uint8_t> bandByDepth; // the last entry covers everything deeper
+
+    OreTable() {
+        for (std::size_t b = 0; b < ORE_BAND_COUNT; ++b) {
+            std::size_t draw = 0;
+            for (std::size_t kind = 0; kind < ORE_BANDS[b].percent.size(); ++kind) {
+                for (int p = 0; p < ORE_BANDS[b].percent[kind] && draw < 100; ++p) {
+                    tiles[b][draw++] = ORE_TILES[kind];
                 }
             }
-            else if (tiles[index] == TILE_LAVA) {
-                if (x > 0 && tiles[x - 1 + y * width] == TILE_WATER) {
-                    tiles[index] = TILE_OBSIDIAN;
-                }
-                if (x < width - 1 && tiles[x + 1 + y * width] == TILE_WATER) {
-                    tiles[index] = TILE_OBSIDIAN;
-                }
-                if (y > 0 && tiles[x + (y - 1) * width] == TILE_WATER) {
-                    tiles[index] = TILE_OBSIDIAN;
-                }
-                if (y < height - 1 && tiles[x + (y + 1) * width] == TILE_WATER) {
-                    tiles[index] = TILE_OBSIDIAN;
-                }
+            for (; draw < 100; ++draw) tiles[b][draw] = TILE_STONE; // rates short of 100%
+        }
+        bandByDepth.assign(static_cast<std::size_t>(ORE_BANDS[ORE_BAND_COUNT - 1].minDepth) + 2, 0);
+        for (std::size_t depth = 0; depth < bandByDepth.size(); ++depth) {
+            for (std::size_t b = 0; b < ORE_BAND_COUNT; ++b) {
+                if (static_cast<int>(depth) > ORE_BANDS[b].minDepth) bandByDepth[depth] = static_cast<std::uint8_t>(b);
             }
         }
     }
-}
-
-void generateCleanTerrainWithLiquids(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    int baseHeight = height - 25;
 
-    for (unsigned int x = 0; x < width; ++x) {
-        int surfaceY = baseHeight;
+    Tile pick(int depth, int draw) const {
+        const std::size_t d = std::min<std::size_t>(static_cast<std::size_t>(std::max(depth, 0)), bandByDepth.size() - 1);
+        return tiles[bandByDepth[d]][static_cast<std::size_t>(draw)];
+    }
+};
+const OreTable ORE_TABLE;
 
-        if (x % 4 == 0) {
-            surfaceY += randomInt(-1, 1);
-        }
+NoiseParams withSeed(NoiseParams params, WorldSeed seed) {
+    params.seed = seed;
+    return params;
+}
 
-        tiles[x + surfaceY * width] = TILE_GRASS;
+const int BEDROCK_ROWS = 3;
+
+// Grass and stone rows of the columns of one chunk column. A pure function of the seed, so every
+// stage that needs them works them out again rather than keeping them around.
+struct ColumnProfile {
+    std::size_t count = 0;
+    int surfaceY[CHUNK_SIZE];
+    int stoneY[CHUNK_SIZE];
+    int topSurfaceY = 0; // the highest of surfaceY
+    int topStoneY = 0;
+};
+
+ColumnProfile getColumnProfile(const TileStorage& tiles, WorldSeed seed, unsigned int cx) {
+    const int height = static_cast<int>(tiles.getHeight());
+    const int baseHeight = height - 25;
+    const int x0 = static_cast<int>(cx << CHUNK_SHIFT);
+
+    ColumnProfile profile;
+    profile.count = std::min<std::size_t>(CHUNK_SIZE, tiles.getWidth() - x0);
+    profile.topSurfaceY = height;
+    profile.topStoneY = height;
+    float noise[CHUNK_SIZE];
+    sampleNoiseRow(withSeed(SURFACE_NOISE, seed), x0, 0, profile.count, noise);
+    for (std::size_t i = 0; i < profile.count; ++i) {
+        profile.surfaceY[i] = baseHeight + static_cast<int>(std::lround(noise[i] * SURFACE_AMPLITUDE));
+        profile.stoneY[i] = profile.surfaceY[i] + 3 + randomInt({ seed, x0 + static_cast<int>(i), 0, RandomPurpose::DirtDepth }, 0, 1);
+        profile.topSurfaceY = std::min(profile.topSurfaceY, profile.surfaceY[i]);
+        profile.topStoneY = std::min(profile.topStoneY, profile.stoneY[i]);
+    }
+    return profile;
+}
 
-        int dirtDepth = 3 + randomInt(0, 1);
-        for (int y = surfaceY + 1; y < surfaceY + dirtDepth; ++y) {
-            if (y < static_cast<int>(height)) {
-                tiles[x + y * width] = TILE_DIRT;
+// Terrain stage: grass, dirt, stone and bedrock for one chunk. Written straight into the chunk,
+// which only this stage run touches.
+void fillTerrainChunk(TileStorage& tiles, WorldSeed seed, unsigned int cx, unsigned int cy) {
+    const TileBounds bounds = getChunkBounds(tiles, cx, cy);
+    const int bedrockY = static_cast<int>(tiles.getHeight()) - BEDROCK_ROWS;
+    const ColumnProfile columns = getColumnProfile(tiles, seed, cx);
+
+    Chunk* chunk = nullptr;
+    for (int y = std::max(bounds.top, std::max(0, std::min(columns.topSurfaceY, bedrockY))); y < bounds.bottom; ++y) {
+        const unsigned int ly = static_cast<unsigned int>(y) & CHUNK_MASK;
+        for (std::size_t i = 0; i < columns.count; ++i) {
+            Tile tile = TILE_AIR;
+            if (y >= bedrockY) {
+                tile = TILE_BEDROCK;
+            }
+            else if (y == columns.surfaceY[i]) {
+                tile = TILE_GRASS;
+            }
+            else if (y > columns.surfaceY[i] && y < columns.stoneY[i]) {
+                tile = TILE_DIRT;
+            }
+            else if (y >= columns.stoneY[i]) {
+                tile = TILE_STONE;
+            }
+            if (tile != TILE_AIR) {
+                if (!chunk) chunk = &tiles.getOrCreateChunk(cx, cy);
+                chunk->set(static_cast<unsigned int>(i), ly, tile);
             }
         }
+    }
 
-        for (int y = surfaceY + dirtDepth; y < static_cast<int>(height) - 3; ++y) {
-            if (y < static_cast<int>(height)) {
-                if (y > surfaceY + dirtDepth + 5) {
-                    if (randomInt(0, 100) < 5) {
-                        tiles[x + y * width] = TILE_COAL_ORE;
-                    }
-                    else if (randomInt(0, 100) < 3 && y > surfaceY + 10) {
-                        tiles[x + y * width] = TILE_IRON_ORE;
-                    }
-                    else if (randomInt(0, 100) < 2 && y > surfaceY + 15) {
-                        tiles[x + y * width] = TILE_GOLD_ORE;
-                    }
-                    else if (randomInt(0, 100) < 1 && y > surfaceY + 15) {
-                        tiles[x + y * width] = TILE_DIAMOND_ORE;
-                    }
-                    else {
-                        tiles[x + y * width] = TILE_STONE;
-                    }
-                }
-                else {
-                    tiles[x + y * width] = TILE_STONE;
+    // The chunk was written directly, so record the grass rows that fall inside it here
+    for (std::size_t i = 0; i < columns.count; ++i) {
+        const int surfaceY = columns.surfaceY[i];
+        if (surfaceY >= bounds.top && surfaceY < bounds.bottom && surfaceY < bedrockY) {
+            tiles.setSurfaceY(static_cast<unsigned int>(bounds.left) + static_cast<unsigned int>(i), surfaceY);
+        }
+    }
+}
+
+// A cave dug below ground around a pool of lava or water. The caves stage carves it and the
+// liquids stage fills the pool; both work the same list out from the seed.
+struct UndergroundPool {
+    int x;
+    int y;
+    int caveSize;
+    int poolSize;
+    Tile liquid;
+};
+
+std::vector<UndergroundPool> planUndergroundPools(const TileStorage& tiles, WorldSeed seed) {
+    const int width = static_cast<int>(tiles.getWidth());
+    const int height = static_cast<int>(tiles.getHeight());
+    std::vector<UndergroundPool> pools;
+    for (int i = 0; i < 6; ++i) {
+        pools.push_back({ randomInt({ seed, i, 0, RandomPurpose::LavaPool, 0 }, 10, width - 11),
+            randomInt({ seed, i, 0, RandomPurpose::LavaPool, 1 }, height / 2 + 10, height - 15),
+            randomInt({ seed, i, 0, RandomPurpose::LavaPool, 2 }, 3, 5),
+            randomInt({ seed, i, 0, RandomPurpose::LavaPool, 3 }, 2, 4), TILE_LAVA });
+    }
+    for (int i = 0; i < 5; ++i) {
+        pools.push_back({ randomInt({ seed, i, 0, RandomPurpose::WaterCave, 0 }, 10, width - 11),
+            randomInt({ seed, i, 0, RandomPurpose::WaterCave, 1 }, height / 2 + 5, height - 10),
+            randomInt({ seed, i, 0, RandomPurpose::WaterCave, 2 }, 3, 6),
+            randomInt({ seed, i, 0, RandomPurpose::WaterCave, 3 }, 2, 4), TILE_WATER });
+    }
+    return pools;
+}
+
+// Caves stage: noise caves in the stone under the dirt, then the pool caves that reach into the chunk
+void carveCaveChunk(TileStorage& tiles, WorldSeed seed, unsigned int cx, unsigned int cy,
+    const std::vector<UndergroundPool>& pools) {
+    Chunk* chunk = tiles.getChunk(cx, cy);
+    if (!chunk) return; // all air
+
+    const TileBounds bounds = getChunkBounds(tiles, cx, cy);
+    const ColumnProfile columns = getColumnProfile(tiles, seed, cx);
+    const int top = std::max(bounds.top, columns.topStoneY + 4);
+    const int bottom = std::min(bounds.bottom, static_cast<int>(tiles.getHeight()) - BEDROCK_ROWS);
+    if (top < bottom) {
+        // The strip walks down the chunk and reuses each hashed lattice row for the rows under it
+        NoiseStrip caveStrip(withSeed(CAVE_NOISE, seed), bounds.left, columns.count);
+        float cave[CHUNK_SIZE];
+        for (int y = top; y < bottom; ++y) {
+            caveStrip.sampleRow(y, cave);
+            const unsigned int ly = static_cast<unsigned int>(y) & CHUNK_MASK;
+            for (std::size_t i = 0; i < columns.count; ++i) {
+                if (y > columns.stoneY[i] + 3 && cave[i] > CAVE_THRESHOLD) {
+                    chunk->set(static_cast<unsigned int>(i), ly, TILE_AIR);
                 }
             }
         }
+    }
+
+    for (const UndergroundPool& pool : pools) {
+        carveCave(tiles, pool.x, pool.y, pool.caveSize, bounds);
+    }
+}
 
-        for (int y = static_cast<int>(height) - 3; y < static_cast<int>(height); ++y) {
-            if (y < static_cast<int>(height)) {
-                tiles[x + y * width] = TILE_BEDROCK;
+// Ores stage: veins in whatever stone the caves left
+void placeOreChunk(TileStorage& tiles, WorldSeed seed, unsigned int cx, unsigned int cy) {
+    Chunk* chunk = tiles.getChunk(cx, cy);
+    if (!chunk) return;
+
+    const TileBounds bounds = getChunkBounds(tiles, cx, cy);
+    const ColumnProfile columns = getColumnProfile(tiles, seed, cx);
+    const int top = std::max(bounds.top, columns.topStoneY + 6);
+    const int bottom = std::min(bounds.bottom, static_cast<int>(tiles.getHeight()) - BEDROCK_ROWS);
+    if (top >= bottom) return;
+
+    NoiseStrip veinStrip(withSeed(ORE_VEIN_NOISE, seed), bounds.left, columns.count);
+    float vein[CHUNK_SIZE];
+    for (int y = top; y < bottom; ++y) {
+        veinStrip.sampleRow(y, vein);
+        const unsigned int ly = static_cast<unsigned int>(y) & CHUNK_MASK;
+        for (std::size_t i = 0; i < columns.count; ++i) {
+            if (y > columns.stoneY[i] + 5 && vein[i] > ORE_VEIN_THRESHOLD
+                && chunk->get(static_cast<unsigned int>(i), ly) == TILE_STONE) {
+                const int draw = randomInt({ seed, (bounds.left + static_cast<int>(i)) >> ORE_REGION_SHIFT,
+                    y >> ORE_REGION_SHIFT, RandomPurpose::Ore }, 0, 99);
+                chunk->set(static_cast<unsigned int>(i), ly, ORE_TABLE.pick(y - columns.surfaceY[i], draw));
             }
         }
     }
+}
 
-    std::cout << "Generating surface water pools..." << std::endl;
+struct LiquidPool {
+    int x;
+    int y;
+    int size;
+    Tile liquid;
+};
+
+// Surface ponds first, then the pools in the underground caves, in the order they are filled
+std::vector<LiquidPool> planLiquidPools(const TileStorage& tiles, WorldSeed seed) {
+    const int width = static_cast<int>(tiles.getWidth());
+    const int height = static_cast<int>(tiles.getHeight());
+    std::vector<LiquidPool> pools;
     for (int i = 0; i < 4; ++i) {
-        int poolX = randomInt(15, width - 16);
-        int surfaceY = -1;
-        //Find surface height
-        for (unsigned int y = 0; y < height; ++y) {
-            if (tiles[poolX + y * width] == TILE_GRASS) {
-                surfaceY = static_cast<int>(y);
-                break;
-            }
+        const int poolX = randomInt({ seed, i, 0, RandomPurpose::SurfaceWaterPool, 0 }, 15, width - 16);
+        const int surfaceY = getColumnProfile(tiles, seed, static_cast<unsigned int>(poolX) >> CHUNK_SHIFT)
+            .surfaceY[static_cast<unsigned int>(poolX) & CHUNK_MASK];
+        if (surfaceY > 0 && surfaceY < height - 5) {
+            pools.push_back({ poolX, surfaceY + 1, randomInt({ seed, i, 0, RandomPurpose::SurfaceWaterPool, 1 }, 2, 4), TILE_WATER });
         }
+    }
+    for (const UndergroundPool& pool : planUndergroundPools(tiles, seed)) {
+        pools.push_back({ pool.x, pool.y, pool.poolSize, pool.liquid });
+    }
+    return pools;
+}
 
-        if (surfaceY > 0 && surfaceY < static_cast<int>(height) - 5) {
-            std::cout << "Water pool at: " << poolX << ", " << surfaceY + 1 << std::endl;
-            generateWaterPool(tiles, width, height, poolX, surfaceY + 1, randomInt(2, 4));
+// Chunk columns [first, last] as a world of their own, walled in at both sides. Liquid moves only
+// through air and never onto grass, so pasting the chunks back leaves the surface rows right.
+TileStorage copyColumns(const TileStorage& tiles, unsigned int first, unsigned int last) {
+    const unsigned int x0 = first << CHUNK_SHIFT;
+    TileStorage columns(std::min((last + 1) << CHUNK_SHIFT, tiles.getWidth()) - x0, tiles.getHeight());
+    for (unsigned int cx = first; cx <= last; ++cx) {
+        for (unsigned int cy = 0; cy < tiles.getChunksY(); ++cy) {
+            if (const Chunk* chunk = tiles.getChunk(cx, cy)) columns.getOrCreateChunk(cx - first, cy) = *chunk;
         }
     }
+    return columns;
+}
 
-    std::cout << "Generating underground lava pools..." << std::endl;
-    for (int i = 0; i < 6; ++i) {
-        int lavaX = randomInt(10, width - 11);
-        int lavaY = randomInt(height / 2 + 10, height - 15);
-
-        std::cout << "Lava pool at: " << lavaX << ", " << lavaY << std::endl;
-        generateUndergroundCave(tiles, width, height, lavaX, lavaY, randomInt(3, 5));
-        generateLavaPool(tiles, width, height, lavaX, lavaY, randomInt(2, 4));
+void pasteColumns(TileStorage& tiles, const TileStorage& columns, unsigned int first) {
+    for (unsigned int cx = 0; cx < columns.getChunksX(); ++cx) {
+        for (unsigned int cy = 0; cy < columns.getChunksY(); ++cy) {
+            if (const Chunk* chunk = columns.getChunk(cx, cy)) tiles.getOrCreateChunk(first + cx, cy) = *chunk;
+        }
     }
+}
 
-    std::cout << "Generating underground water pools..." << std::endl;
-    for (int i = 0; i < 5; ++i) {
-        int waterX = randomInt(10, width - 11);
-        int waterY = randomInt(height / 2 + 5, height - 10);
-
-        std::cout << "Water cave at: " << waterX << ", " << waterY << std::endl;
-        generateUndergroundCave(tiles, width, height, waterX, waterY, randomInt(3, 6));
-        generateWaterPool(tiles, width, height, waterX, waterY, randomInt(2, 4));
+// Steps until the stop rule described at LiquidSettleReport is met, or maxTicks have run
+void runUntilSettled(LiquidSimulator& liquids, TileStorage& tiles, unsigned int maxTicks, LiquidSettleReport& report) {
+    while (!report.settled && report.ticks < maxTicks) {
+        if (liquids.getActiveCount() == 0) {
+            report.settled = true;
+            break;
+        }
+        liquids.step(tiles);
+        ++report.ticks;
+        report.movedCells += liquids.getMoveCount();
+        report.hardenedCells += liquids.getHardenedCount();
+
+        // The stop rule, judged on the tiles after the tick (a sideways move can still leave liquid
+        // over air). Moves alone never reach 0: films on open ground wander for good. A pool spreads
+        // as a wall of liquid with nothing falling, so it also has to have levelled out.
+        report.settled = liquids.getHardenedCount() == 0 && liquids.countFalling(tiles) == 0
+            && liquids.countLevelling(tiles) == 0;
     }
+    report.restlessCells = liquids.getActiveCount();
+    report.unsupportedCells = countLiquidOverAir(tiles);
+}
 
-    
-    std::cout << "Checking liquid interactions..." << std::endl;
-    checkLiquidInteractions(tiles, width, height);
+// Liquids stage, one chunk column at a time: the liquid flows until it rests. Most of it only
+// falls inside its column, so the column is settled on a copy of its own, walled in at both
+// sides; what would still spread past a wall is left to the seams stage.
+LiquidSettleReport settleColumn(TileStorage& tiles, WorldSeed seed, unsigned int cx) {
+    TileStorage column = copyColumns(tiles, cx, cx);
+    checkLiquidInteractions(column);
+    const LiquidSettleReport report = settleLiquids(column, seed);
+    pasteColumns(tiles, column, cx);
+    return report;
+}
+
+// Columns settle independently, on different threads, into one report for the whole world
+void addSettleReport(LiquidSettleReport& total, const LiquidSettleReport& column, bool first) {
+    total.ticks = std::max(total.ticks, column.ticks);
+    total.movedCells += column.movedCells;
+    total.hardenedCells += column.hardenedCells;
+    total.restlessCells += column.restlessCells;
+    total.unsupportedCells += column.unsupportedCells;
+    total.settled = (first || total.settled) && column.settled;
+}
 
-    
-    std::cout << "Simulating liquid flow..." << std::endl;
-    for (int i = 0; i < 10; ++i) { 
-        simulateWaterFlow(tiles, width, height);
-        simulateLavaFlow(tiles, width, height);
-        checkLiquidInteractions(tiles, width, height);
+// Liquid with air on either side, which the simulator would still move sideways
+std::size_t countSpreadingLiquid(const TileStorage& tiles) {
+    const unsigned int width = tiles.getWidth();
+    std::size_t count = 0;
+    for (unsigned int y = 0; y < tiles.getHeight(); ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            if (!isLiquidTile(tiles.getTile(x, y))) continue;
+            if ((x > 0 && tiles.getTile(x - 1, y) == TILE_AIR) || (x + 1 < width && tiles.getTile(x + 1, y) == TILE_AIR)) ++count;
+        }
     }
+    return count;
 }
 
-void generateNiceTrees(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    for (unsigned int i = 0; i < 20; ++i) {
-        unsigned int treeX = randomInt(5, width - 6);
-        int surfaceY = -1;
+// The seam pass runs after every column has settled, so it adds its ticks to theirs. The counts
+// of liquid left over air or spreading are taken from the real world afterwards, not summed from
+// the walled copies.
+void addSeamReport(LiquidSettleReport& total, const LiquidSettleReport& seams, const TileStorage& tiles) {
+    total.ticks += seams.ticks;
+    total.movedCells += seams.movedCells;
+    total.hardenedCells += seams.hardenedCells;
+    total.restlessCells = countSpreadingLiquid(tiles);
+    total.unsupportedCells = seams.unsupportedCells;
+    total.settled = total.settled && seams.settled && seams.unsupportedCells == 0;
+}
 
-        for (unsigned int y = 0; y < height; ++y) {
-            if (tiles[treeX + y * width] == TILE_GRASS) {
-                surfaceY = static_cast<int>(y);
-                break;
-            }
-        }
+struct TreePlan {
+    int x;
+    Tile trunk;
+    int trunkHeight;
+};
+const int LEAF_RADIUS = 2;
 
-        if (surfaceY > 5) {
-            // Select tree type randomly
-            int treeType = randomInt(0, 10);
-            int trunkTile;
+std::vector<TreePlan> planTrees(const TileStorage& tiles, WorldSeed seed) {
+    const unsigned int width = tiles.getWidth();
+    std::vector<TreePlan> trees;
+    for (unsigned int i = 0; i < 20; ++i) {
+        TreePlan tree;
+        tree.x = static_cast<int>(randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Tree, 0 }, 5, width - 6));
 
-            if (treeType < 7) {
-                trunkTile = TILE_LOG;        // Normal tree %70
-            }
-            else if (treeType < 9) {
-                trunkTile = TILE_DARK_LOG;   // Dark tree %20
-            }
-            else {
-                trunkTile = TILE_WHITE_LOG;  // White tree %10
-            }
+        // Select tree type randomly
+        int treeType = randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Tree, 1 }, 0, 10);
+        if (treeType < 7) {
+            tree.trunk = TILE_LOG;        // Normal tree %70
+        }
+        else if (treeType < 9) {
+            tree.trunk = TILE_DARK_LOG;   // Dark tree %20
+        }
+        else {
+            tree.trunk = TILE_WHITE_LOG;  // White tree %10
+        }
+        tree.trunkHeight = randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Tree, 2 }, 4, 6);
+        trees.push_back(tree);
+    }
+    return trees;
+}
 
-            int trunkHeight = randomInt(4, 6);
-            for (int dy = 1; dy <= trunkHeight; ++dy) {
-                int trunkY = surfaceY - dy;
-                if (trunkY >= 0) {
-                    tiles[treeX + trunkY * width] = trunkTile;
-                }
+// Trees stage: the parts of every tree that fall inside the chunk. Roots sit on the surface of the
+// neighbouring chunks too, which the stage's neighbour radius has finished by now.
+void growTreesInChunk(TileStorage& tiles, const std::vector<TreePlan>& trees, const TileBounds& bounds) {
+    for (const TreePlan& tree : trees) {
+        if (tree.x + LEAF_RADIUS < bounds.left || tree.x - LEAF_RADIUS >= bounds.right) continue;
+        const int surfaceY = tiles.getSurfaceY(tree.x);
+        if (surfaceY <= 5) continue;
+
+        for (int dy = 1; dy <= tree.trunkHeight; ++dy) {
+            if (bounds.contains(tree.x, surfaceY - dy)) {
+                tiles.setTile(tree.x, surfaceY - dy, tree.trunk);
             }
+        }
 
-            int leafStartY = surfaceY - trunkHeight;
-            int leafSize = 2;
-
-            for (int ly = leafStartY; ly >= leafStartY - 2; --ly) {
-                for (int lx = treeX - leafSize; lx <= treeX + leafSize; ++lx) {
-                    if (lx >= 0 && lx < static_cast<int>(width) && ly >= 0) {
-                        if (std::abs(lx - static_cast<int>(treeX)) <= leafSize &&
-                            std::abs(ly - leafStartY) <= 2) {
-                            if (tiles[lx + ly * width] == TILE_AIR) {
-                                tiles[lx + ly * width] = TILE_LEAVES;
-                            }
-                        }
-                    }
+        int leafStartY = surfaceY - tree.trunkHeight;
+        for (int ly = leafStartY; ly >= leafStartY - 2; --ly) {
+            for (int lx = tree.x - LEAF_RADIUS; lx <= tree.x + LEAF_RADIUS; ++lx) {
+                if (bounds.contains(lx, ly) && tiles.getTile(lx, ly) == TILE_AIR) {
+                    tiles.setTile(lx, ly, TILE_LEAVES);
                 }
             }
         }
     }
 }
 
-void generateSimpleDetails(std::vector<int>& tiles, unsigned int width, unsigned int height) {
+struct PlantPlan {
+    int x;
+    Tile tile;
+};
+
+// At most one plant per column: a plant is placed on the surface, and a grass plant becomes the
+// surface itself, so a second one would land wherever the first happened to be by then
+std::vector<PlantPlan> planPlants(const TileStorage& tiles, WorldSeed seed) {
+    const unsigned int width = tiles.getWidth();
+    std::vector<PlantPlan> plants;
     for (unsigned int i = 0; i < 30; ++i) {
-        unsigned int plantX = randomInt(2, width - 3);
-        int surfaceY = -1;
+        const int plantX = static_cast<int>(randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 0 }, 2, width - 3));
+        Tile tile = TILE_AIR;
+        if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 1 }, 0, 99) < 60) {
+            tile = TILE_GRASS;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 2 }, 0, 99) < 40) {
+            tile = TILE_PUMPKIN;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 3 }, 0, 99) < 40) {
+            tile = TILE_MELON;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 4 }, 0, 99) < 40) {
+            tile = TILE_MUSHROOM_RED;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 5 }, 0, 99) < 40) {
+            tile = TILE_MUSHROOM_BROWN;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 6 }, 0, 99) < 50) {
+            tile = TILE_FLOWER_RED;
+        }
+        else if (randomInt({ seed, static_cast<int>(i), 0, RandomPurpose::Plant, 7 }, 0, 99) < 50) {
+            tile = TILE_FLOWER_YELLOW;
+        }
 
-        for (unsigned int y = 0; y < height; ++y) {
-            if (tiles[plantX + y * width] == TILE_GRASS) {
-                surfaceY = static_cast<int>(y);
-                break;
-            }
+        const bool taken = std::any_of(plants.begin(), plants.end(), [plantX](const PlantPlan& p) { return p.x == plantX; });
+        if (tile != TILE_AIR && !taken) {
+            plants.push_back({ plantX, tile });
         }
+    }
+    return plants;
+}
 
-        if (surfaceY > 0) {
-            int plantY = surfaceY - 1;
-            if (plantY >= 0 && tiles[plantX + plantY * width] == TILE_AIR) {
-                if (randomInt(0, 99) < 60) {
-                    tiles[plantX + plantY * width] = TILE_GRASS;
-                }
-                else if (randomInt(0, 99) < 40) {
-                    tiles[plantX + plantY * width] = TILE_PUMPKIN;
-                }
-                else if (randomInt(0, 99) < 40) {
-                    tiles[plantX + plantY * width] = TILE_MELON;
-                }
-                else if (randomInt(0, 99) < 40) {
-                    tiles[plantX + plantY * width] = TILE_MUSHROOM_RED;
-                }
-                else if (randomInt(0, 99) < 40) {
-                    tiles[plantX + plantY * width] = TILE_MUSHROOM_BROWN;
-                }
-                else if (randomInt(0, 99) < 50) {
-                    tiles[plantX + plantY * width] = TILE_FLOWER_RED;
-                }
-                else if (randomInt(0, 99) < 50) {
-                    tiles[plantX + plantY * width] = TILE_FLOWER_YELLOW;
+// Decorations stage: plants whose spot, just above the surface, is inside the chunk. decided[k] is
+// set once plant k is placed or its spot found taken, so the chunk above never plants on top of a
+// grass plant it sees as the new surface. Bytes, not vector<bool>: columns run on different threads.
+void plantInChunk(TileStorage& tiles, const std::vector<PlantPlan>& plants, std::vector<std::uint8_t>& decided,
+    const TileBounds& bounds) {
+    for (std::size_t k = 0; k < plants.size(); ++k) {
+        const PlantPlan& plant = plants[k];
+        if (decided[k] || plant.x < bounds.left || plant.x >= bounds.right) continue;
+        const int surfaceY = tiles.getSurfaceY(plant.x);
+        if (surfaceY <= 0 || !bounds.contains(plant.x, surfaceY - 1)) continue;
+
+        decided[k] = 1;
+        if (tiles.getTile(plant.x, surfaceY - 1) == TILE_AIR) {
+            tiles.setTile(plant.x, surfaceY - 1, plant.tile);
+        }
+    }
+}
+
+} // namespace
+
+void simulateWaterFlow(TileStorage& tiles, WorldSeed seed, std::uint32_t tick, ThreadPool* pool) {
+    flowLiquid(tiles, TILE_WATER, seed, tick, pool);
+}
+
+void simulateLavaFlow(TileStorage& tiles, WorldSeed seed, std::uint32_t tick, ThreadPool* pool) {
+    flowLiquid(tiles, TILE_LAVA, seed, tick, pool);
+}
+
+void checkLiquidInteractions(TileStorage& tiles) {
+    const int height = static_cast<int>(tiles.getHeight());
+    LiquidRows& rows = liquidRows;
+    rows.resize(tiles.getChunksX());
+
+    // Only lava changes, so rows can be read once each and handed to hardenRow as a sliding window
+    if (height > 0) copyRowBits(tiles, 0, rows.settledBelow);
+    for (int y = 0; y < height; ++y) {
+        std::swap(rows.settledAbove, rows.settled);
+        std::swap(rows.settled, rows.settledBelow);
+        if (y + 1 < height) copyRowBits(tiles, y + 1, rows.settledBelow);
+        hardenRow(tiles, y, y > 0 ? &rows.settledAbove : nullptr,
+            rows.settled, y + 1 < height ? &rows.settledBelow : nullptr);
+    }
+}
+
+LiquidSettleReport settleLiquids(TileStorage& tiles, WorldSeed seed, unsigned int maxTicks) {
+    LiquidSettleReport report;
+    LiquidSimulator liquids(seed);
+    liquids.reset(tiles);
+    runUntilSettled(liquids, tiles, maxTicks, report);
+    return report;
+}
+
+LiquidSettleReport settleLiquidSeams(TileStorage& tiles, WorldSeed seed, unsigned int firstColumn, unsigned int lastColumn,
+    unsigned int maxTicks) {
+    LiquidSettleReport report;
+    if (tiles.getChunksX() == 0) return report;
+    lastColumn = std::min(lastColumn, tiles.getChunksX() - 1);
+    if (firstColumn > lastColumn) return report;
+
+    // The whole world settles in place; a range is settled walled in, like a single column
+    const bool wholeWorld = firstColumn == 0 && lastColumn == tiles.getChunksX() - 1;
+    TileStorage range = wholeWorld ? TileStorage() : copyColumns(tiles, firstColumn, lastColumn);
+    TileStorage& world = wholeWorld ? tiles : range;
+
+    // Every column has settled against its walls, so only the liquid right next to a seam
+    // has anywhere new to go; the simulator follows whatever that sets moving
+    LiquidSimulator liquids(seed);
+    liquids.clear(world);
+    for (unsigned int cx = 1; cx < world.getChunksX(); ++cx) {
+        const unsigned int x = cx << CHUNK_SHIFT;
+        for (unsigned int y = 0; y < world.getHeight(); ++y) {
+            if (isLiquidTile(world.getTile(x - 1, y))) liquids.wake(x - 1, y);
+            if (isLiquidTile(world.getTile(x, y))) liquids.wake(x, y);
+        }
+    }
+    runUntilSettled(liquids, world, maxTicks, report);
+
+    if (!wholeWorld) pasteColumns(tiles, range, firstColumn);
+    return report;
+}
+
+std::size_t countLiquidOverAir(const TileStorage& tiles) {
+    const unsigned int height = tiles.getHeight();
+    std::size_t count = 0;
+    for (unsigned int cy = 0; cy < tiles.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < tiles.getChunksX(); ++cx) {
+            const Chunk* chunk = tiles.getChunk(cx, cy);
+            if (!chunk) continue;
+
+            // Row by row on the bitboards; the row under the chunk's last one is in the chunk below
+            const Chunk* below = cy + 1 < tiles.getChunksY() ? tiles.getChunk(cx, cy + 1) : nullptr;
+            const unsigned int y0 = cy << CHUNK_SHIFT;
+            for (unsigned int ly = 0; ly < CHUNK_SIZE && y0 + ly + 1 < height; ++ly) {
+                const std::uint64_t airBelow = ly + 1 < CHUNK_SIZE ? chunk->air[ly + 1]
+                    : below ? below->air[0] : ~std::uint64_t{ 0 };
+                for (std::uint64_t bits = (chunk->water[ly] | chunk->lava[ly]) & airBelow; bits; bits &= bits - 1) {
+                    ++count;
                 }
             }
         }
     }
+    return count;
 }
 
-void updateWorld(std::vector<int>& tiles, unsigned int width, unsigned int height) {
-    simulateWaterFlow(tiles, width, height);
-    simulateLavaFlow(tiles, width, height);
-    checkLiquidInteractions(tiles, width, height);
+void addWorldGenerationStages(WorldPipeline& pipeline, WorldSeed seed, LiquidSettleReport* settled) {
+    // Plans are worked out from the seed by each stage's prepare step and shared with its chunk runs
+    auto undergroundPools = std::make_shared<std::vector<UndergroundPool>>();
+    auto trees = std::make_shared<std::vector<TreePlan>>();
+    struct Plants {
+        std::vector<PlantPlan> plans;
+        std::vector<std::uint8_t> decided;
+    };
+    auto plants = std::make_shared<Plants>();
+    auto liquidPools = std::make_shared<std::vector<LiquidPool>>();
+    struct SettleTotal {
+        std::mutex mutex;
+        LiquidSettleReport* total;
+        unsigned int columns = 0;
+    };
+    auto settle = std::make_shared<SettleTotal>();
+    settle->total = settled;
+
+    GenerationStage terrain;
+    terrain.name = "terrain";
+    terrain.label = "Shaping terrain";
+    terrain.runChunk = [seed](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        fillTerrainChunk(tiles, seed, cx, cy);
+    };
+    pipeline.addStage(std::move(terrain));
+
+    GenerationStage caves;
+    caves.name = "caves";
+    caves.label = "Digging caves";
+    caves.prepare = [seed, undergroundPools](TileStorage& tiles) {
+        *undergroundPools = planUndergroundPools(tiles, seed);
+    };
+    caves.runChunk = [seed, undergroundPools](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        carveCaveChunk(tiles, seed, cx, cy, *undergroundPools);
+    };
+    pipeline.addStage(std::move(caves));
+
+    GenerationStage ores;
+    ores.name = "ores";
+    ores.label = "Placing ores";
+    ores.runChunk = [seed](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        placeOreChunk(tiles, seed, cx, cy);
+    };
+    pipeline.addStage(std::move(ores));
+
+    // Pools are cut into the chunks they overlap; the ponds sit on the surface the terrain noise
+    // gives, whatever the caves did to it, so every chunk works out the same pools
+    GenerationStage pools;
+    pools.name = "pools";
+    pools.label = "Filling pools";
+    pools.prepare = [seed, liquidPools](TileStorage& tiles) { *liquidPools = planLiquidPools(tiles, seed); };
+    pools.runChunk = [liquidPools](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        const TileBounds bounds = getChunkBounds(tiles, cx, cy);
+        for (const LiquidPool& pool : *liquidPools) {
+            fillPool(tiles, pool.x, pool.y, pool.size, pool.liquid, bounds);
+        }
+    };
+    pipeline.addStage(std::move(pools));
+
+    GenerationStage liquids;
+    liquids.name = "liquids";
+    liquids.label = "Settling liquids";
+    liquids.wholeColumn = true;
+    liquids.runColumn = [seed, settle](TileStorage& tiles, unsigned int cx) {
+        const LiquidSettleReport report = settleColumn(tiles, seed, cx);
+        if (settle->total) {
+            std::lock_guard<std::mutex> lock(settle->mutex);
+            addSettleReport(*settle->total, report, settle->columns++ == 0);
+        }
+    };
+    pipeline.addStage(std::move(liquids));
+
+    // Leaves reach LEAF_RADIUS tiles sideways and trees up to 8 tiles above their surface, so a
+    // chunk's trees may stand on the surface of any chunk next to it
+    GenerationStage treeStage;
+    treeStage.name = "trees";
+    treeStage.label = "Growing trees";
+    treeStage.neighbourRadius = 1;
+    treeStage.prepare = [seed, trees](TileStorage& tiles) { *trees = planTrees(tiles, seed); };
+    treeStage.runChunk = [trees](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        growTreesInChunk(tiles, *trees, getChunkBounds(tiles, cx, cy));
+    };
+    pipeline.addStage(std::move(treeStage));
+
+    // A plant on the top row of a chunk stands on the chunk below, and must not be placed before
+    // the trees of either chunk have taken their tiles
+    GenerationStage decorations;
+    decorations.name = "decorations";
+    decorations.label = "Planting details";
+    decorations.neighbourRadius = 1;
+    decorations.prepare = [seed, plants](TileStorage& tiles) {
+        plants->plans = planPlants(tiles, seed);
+        plants->decided.assign(plants->plans.size(), 0);
+    };
+    decorations.runChunk = [plants](TileStorage& tiles, unsigned int cx, unsigned int cy) {
+        plantInChunk(tiles, plants->plans, plants->decided, getChunkBounds(tiles, cx, cy));
+    };
+    pipeline.addStage(std::move(decorations));
+
+    // The columns settled walled in; this lets the liquid at their seams go on across, over the
+    // whole world at once since it may run on into columns further away
+    GenerationStage seams;
+    seams.name = "seams";
+    seams.label = "Settling liquids between columns";
+    seams.wholeWorld = true;
+    seams.runWorld = [seed, settle](TileStorage& tiles) {
+        const LiquidSettleReport report = settleLiquidSeams(tiles, seed, 0, tiles.getChunksX() - 1);
+        if (settle->total) {
+            std::lock_guard<std::mutex> lock(settle->mutex);
+            addSeamReport(*settle->total, report, tiles);
+        }
+    };
+    pipeline.addStage(std::move(seams));
+}
+
+LiquidSettleReport generateWorld(TileStorage& tiles, WorldSeed seed, ThreadPool* pool, WorldGenerationProgress* progress) {
+    LiquidSettleReport settled;
+    WorldPipeline pipeline(tiles);
+    addWorldGenerationStages(pipeline, seed, &settled);
+    pipeline.runAll(pool, progress);
+    return settled;
+}
+
+void updateWorld(TileStorage& tiles, WorldSeed seed, std::uint32_t tick) {
+    // Water flow, lava flow and hardening fused into one bottom-up sweep, so each row is pulled
+    // into cache once instead of three times. The stages trail each other by a few rows:
+    //   water at row r     reads rows r, r+1 before the tick
+    //   lava at row r+1    reads rows r+1, r+2 after all water that can reach them has moved
+    //   harden at row r+3  reads rows r+2..r+4 once no water or lava can reach them any more
+    // so every stage sees exactly what it would see in its own full pass.
+    const int height = static_cast<int>(tiles.getHeight());
+    LiquidRows& rows = liquidRows;
+    rows.resize(tiles.getChunksX());
+
+    for (int r = height - 1; r >= -3; --r) {
+        if (r >= 0) {
+            std::swap(rows.current, rows.below);
+            copyRowBits(tiles, r, rows.current);
+            flowRow(tiles, TILE_WATER, r, rows.current, r < height - 1 ? &rows.below : nullptr, seed, tick);
+        }
+
+        const int lavaRow = r + 1;
+        if (lavaRow >= 0 && lavaRow < height) {
+            std::swap(rows.lavaCurrent, rows.lavaBelow);
+            copyRowBits(tiles, lavaRow, rows.lavaCurrent);
+            flowRow(tiles, TILE_LAVA, lavaRow, rows.lavaCurrent, lavaRow < height - 1 ? &rows.lavaBelow : nullptr, seed, tick);
+        }
+
+        const int hardenRowY = r + 3;
+        std::swap(rows.settledBelow, rows.settled);
+        std::swap(rows.settled, rows.settledAbove);
+        if (r + 2 >= 0 && r + 2 < height) {
+            copyRowBits(tiles, r + 2, rows.settledAbove);
+        }
+        if (hardenRowY >= 0 && hardenRowY < height) {
+            hardenRow(tiles, hardenRowY, hardenRowY > 0 ? &rows.settledAbove : nullptr,
+                rows.settled, hardenRowY < height - 1 ? &rows.settledBelow : nullptr);
+        }
+    }
 }
\ No newline at end of file
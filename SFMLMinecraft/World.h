@@ -1,14 +1,67 @@
 #pragma once
-#include <SFML/Graphics.hpp>
-#include <iostream>
-#include "TileMap.h"
+#include "TileStorage.h"
 #include "TileID.h"
+#include "WorldRandom.h"
 
-bool rectIntersects(const sf::FloatRect& rect1, const sf::FloatRect& rect2);
-int  randomInt(int min, int max);
-void generateWaterPool(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size);
-void generateLavaPool(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size);
-void generateUndergroundCave(std::vector<int>& tiles, unsigned int width, unsigned int height, int centerX, int centerY, int size);
-void generateCleanTerrainWithLiquids(std::vector<int>& tiles, unsigned int width, unsigned int height);
-void generateNiceTrees(std::vector<int>& tiles, unsigned int width, unsigned int height);
-void generateSimpleDetails(std::vector<int>& tiles, unsigned int width, unsigned int height);
+class ThreadPool;
+class WorldGenerationProgress;
+class WorldPipeline;
+
+// World generation and liquid simulation. Headless: depends only on TileStorage, no SFML.
+// All randomness comes from WorldRandom.h, so the same seed always produces the same world.
+void generateWaterPool(TileStorage& tiles, int centerX, int centerY, int size);
+void generateLavaPool(TileStorage& tiles, int centerX, int centerY, int size);
+void generateUndergroundCave(TileStorage& tiles, int centerX, int centerY, int size);
+
+// Liquid in this model never stops moving altogether: a film one cell thick on open ground keeps
+// stepping sideways at random, forever. So settling does not wait for "no liquid moved"; it stops
+// after the first tick in which no lava hardened and that left no liquid with air below it, and
+// none with air beside it and more liquid on top (a pool still levelling out). Every liquid cell
+// then rests on something, and restlessCells counts the films still spreading.
+struct LiquidSettleReport {
+    unsigned int ticks = 0;
+    std::size_t movedCells = 0;     // liquid moves summed over all ticks
+    std::size_t hardenedCells = 0;  // lava turned to obsidian
+    std::size_t restlessCells = 0;  // liquid still spreading sideways at the end
+    std::size_t unsupportedCells = 0; // liquid right above air at the end (countLiquidOverAir)
+    bool settled = false;           // the stop rule was met; false if the tick limit ran out first
+};
+
+// settleLiquids gives up after this many ticks and reports settled == false
+constexpr unsigned int LIQUID_SETTLE_TICK_LIMIT = 4096;
+
+// Adds the generator's stages, in order: terrain, caves, ores and pools per chunk, liquids per
+// chunk column, trees and decorations per chunk (each reading the chunks around it), and last the
+// seams, over the whole world, where liquid crosses from one column into the next. Only that last
+// stage waits for the whole world. The pipeline's world must start empty. Chunks come out the same
+// whatever order they are generated in. Generation prints nothing; the liquids and seams stages
+// report how the liquid settled in settled, if given.
+void addWorldGenerationStages(WorldPipeline& pipeline, WorldSeed seed, LiquidSettleReport* settled = nullptr);
+
+// The whole generator, every chunk through every stage. With a pool each stage runs one chunk
+// column per task; the world is identical. With progress the columns go outwards from its spawn
+// column and are reported as they finish. Returns how the liquids settled.
+LiquidSettleReport generateWorld(TileStorage& tiles, WorldSeed seed, ThreadPool* pool = nullptr,
+    WorldGenerationProgress* progress = nullptr);
+
+// Bump when a generator change alters the worlds it makes, so cached worlds are regenerated.
+// WorldCache also fingerprints a small probe world, which catches the changes that are missed here.
+constexpr std::uint32_t WORLD_GENERATOR_VERSION = 5;
+
+// tick picks the random stream for this step, so a run is reproducible from (seed, tick).
+// With a pool the flow passes run one strip of chunk rows per task; the result is identical.
+void simulateWaterFlow(TileStorage& tiles, WorldSeed seed, std::uint32_t tick, ThreadPool* pool = nullptr);
+void simulateLavaFlow(TileStorage& tiles, WorldSeed seed, std::uint32_t tick, ThreadPool* pool = nullptr);
+void checkLiquidInteractions(TileStorage& tiles);
+
+// Steps the liquid simulator (only moving liquid is visited) until the stop rule described at
+// LiquidSettleReport is met, or maxTicks have run.
+LiquidSettleReport settleLiquids(TileStorage& tiles, WorldSeed seed, unsigned int maxTicks = LIQUID_SETTLE_TICK_LIMIT);
+// The seam pass: wakes only the liquid either side of each boundary between chunk columns
+// firstColumn..lastColumn, which have each settled on their own, and settles from there. A range
+// short of the whole world is walled in at its outer sides, as a single column is.
+LiquidSettleReport settleLiquidSeams(TileStorage& tiles, WorldSeed seed, unsigned int firstColumn, unsigned int lastColumn,
+    unsigned int maxTicks = LIQUID_SETTLE_TICK_LIMIT);
+// Water and lava cells with air directly below them, over the whole world. 0 in a settled world.
+std::size_t countLiquidOverAir(const TileStorage& tiles);
+void updateWorld(TileStorage& tiles, WorldSeed seed, std::uint32_t tick);
@@ -0,0 +1,274 @@
+#include "WorldCache.h"
+#include "World.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// File layout, all in native byte order (the cache never leaves the machine that wrote it):
+//   FileHeader
+//   int32   surface row per column        [width]
+//   uint32  chunk index (cx + cy * chunksX) [chunkCount]
+//   Tile    chunk tiles, row-major          [chunkCount][CHUNK_SIZE * CHUNK_SIZE]
+// Chunks that were never loaded (all air) are not stored.
+constexpr std::uint32_t CACHE_MAGIC = 0x43574D53; // "SMWC"
+constexpr std::uint32_t CACHE_FORMAT = 1;         // bump when the layout above changes
+
+struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t format;
+    std::uint64_t seed;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t generatorVersion;
+    std::uint32_t chunkSize;
+    std::uint64_t generatorFingerprint;
+    std::uint32_t chunkCount;
+    std::uint32_t tileBytes;
+};
+static_assert(sizeof(FileHeader) == 48, "cache header must have no padding");
+
+constexpr std::size_t CHUNK_TILES = static_cast<std::size_t>(CHUNK_SIZE) * CHUNK_SIZE;
+
+std::size_t expectedFileSize(const FileHeader& header) {
+    return sizeof(FileHeader)
+        + static_cast<std::size_t>(header.width) * sizeof(std::int32_t)
+        + static_cast<std::size_t>(header.chunkCount) * (sizeof(std::uint32_t) + CHUNK_TILES * sizeof(Tile));
+}
+
+// Read-only view of a whole file; empty when the file is missing or cannot be mapped
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* getData() const { return file_data; }
+    std::size_t getSize() const { return file_size; }
+
+private:
+    const unsigned char* file_data = nullptr;
+    std::size_t file_size = 0;
+#if defined(_WIN32)
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE file_mapping = nullptr;
+#endif
+};
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string& path)
+{
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) return;
+    file_mapping = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file_mapping) return;
+
+    file_data = static_cast<const unsigned char*>(MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (file_data) file_size = static_cast<std::size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (file_data) UnmapViewOfFile(file_data);
+    if (file_mapping) CloseHandle(file_mapping);
+    if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file_data = static_cast<const unsigned char*>(data);
+            file_size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    close(fd); // the mapping stays valid on its own
+}
+
+MappedFile::~MappedFile()
+{
+    if (file_data) munmap(const_cast<unsigned char*>(file_data), file_size);
+}
+#endif
+
+// FNV-1a over the probe world's tiles
+std::uint64_t hashTiles(const TileStorage& tiles) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned int y = 0; y < tiles.getHeight(); ++y) {
+        for (unsigned int x = 0; x < tiles.getWidth(); ++x) {
+            hash ^= static_cast<std::uint16_t>(tiles.getTile(x, y));
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+std::uint64_t fingerprintGenerator() {
+    // Big enough for every generator step to place something (pools, caves, trees, plants)
+    TileStorage probe(160, 96);
+    generateWorld(probe, 0x5EEDu);
+    return hashTiles(probe);
+}
+
+// Unique per save, so two games writing the same world at once never share a temporary file
+std::string makeTemporaryPath(const std::string& path) {
+    std::random_device random;
+    std::ostringstream name;
+    name << path << '.' << std::hex << random() << random() << ".tmp";
+    return name.str();
+}
+
+} // namespace
+
+WorldCacheKey makeWorldCacheKey(WorldSeed seed, unsigned int width, unsigned int height)
+{
+    static const std::uint64_t fingerprint = fingerprintGenerator();
+
+    WorldCacheKey key;
+    key.seed = seed;
+    key.width = width;
+    key.height = height;
+    key.generatorVersion = WORLD_GENERATOR_VERSION;
+    key.generatorFingerprint = fingerprint;
+    return key;
+}
+
+std::string getWorldCachePath(const std::string& directory, const WorldCacheKey& key)
+{
+    std::ostringstream name;
+    name << "world-" << key.seed << "-" << key.width << "x" << key.height << ".bin";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+bool loadCachedWorld(const std::string& path, const WorldCacheKey& key, TileStorage& tiles)
+{
+    const MappedFile file(path);
+    if (file.getSize() < sizeof(FileHeader)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.format != CACHE_FORMAT
+        || header.chunkSize != CHUNK_SIZE || header.tileBytes != sizeof(Tile)
+        || header.seed != key.seed || header.width != key.width || header.height != key.height
+        || header.generatorVersion != key.generatorVersion
+        || header.generatorFingerprint != key.generatorFingerprint) {
+        return false;
+    }
+
+    TileStorage loaded(header.width, header.height);
+    const std::size_t chunkSlots = static_cast<std::size_t>(loaded.getChunksX()) * loaded.getChunksY();
+    if (header.chunkCount > chunkSlots || file.getSize() != expectedFileSize(header)) return false;
+
+    const unsigned char* cursor = file.getData() + sizeof(FileHeader);
+    std::vector<std::int32_t> surface(header.width);
+    std::memcpy(surface.data(), cursor, surface.size() * sizeof(std::int32_t));
+    cursor += surface.size() * sizeof(std::int32_t);
+    for (std::int32_t row : surface) {
+        if (row < -1 || row >= static_cast<std::int32_t>(header.height)) return false;
+    }
+
+    std::vector<std::uint32_t> indices(header.chunkCount);
+    std::memcpy(indices.data(), cursor, indices.size() * sizeof(std::uint32_t));
+    cursor += indices.size() * sizeof(std::uint32_t);
+
+    // The chunk tiles are read straight out of the mapping. A damaged file must not name a chunk
+    // twice or hold tiles the tile tables have no entry for.
+    const Tile* chunkTiles = reinterpret_cast<const Tile*>(cursor);
+    std::vector<bool> seen(chunkSlots, false);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= chunkSlots || seen[indices[i]]) return false;
+        seen[indices[i]] = true;
+
+        const Tile* source = chunkTiles + i * CHUNK_TILES;
+        for (std::size_t t = 0; t < CHUNK_TILES; ++t) {
+            if (source[t] < TILE_AIR || source[t] >= TILE_COUNT) return false;
+        }
+        Chunk& chunk = loaded.getOrCreateChunk(indices[i] % loaded.getChunksX(), indices[i] / loaded.getChunksX());
+        chunk.assign(source);
+    }
+    for (unsigned int x = 0; x < header.width; ++x) {
+        loaded.setSurfaceY(x, surface[x]);
+    }
+
+    tiles = std::move(loaded);
+    return true;
+}
+
+bool saveCachedWorld(const std::string& path, const WorldCacheKey& key, const TileStorage& tiles)
+{
+    std::vector<std::uint32_t> indices;
+    for (unsigned int cy = 0; cy < tiles.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < tiles.getChunksX(); ++cx) {
+            if (tiles.getChunk(cx, cy)) indices.push_back(cx + cy * tiles.getChunksX());
+        }
+    }
+    std::vector<std::int32_t> surface(tiles.getWidth());
+    for (unsigned int x = 0; x < tiles.getWidth(); ++x) {
+        surface[x] = tiles.getSurfaceY(x);
+    }
+
+    FileHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.format = CACHE_FORMAT;
+    header.seed = key.seed;
+    header.width = tiles.getWidth();
+    header.height = tiles.getHeight();
+    header.generatorVersion = key.generatorVersion;
+    header.chunkSize = CHUNK_SIZE;
+    header.generatorFingerprint = key.generatorFingerprint;
+    header.chunkCount = static_cast<std::uint32_t>(indices.size());
+    header.tileBytes = sizeof(Tile);
+
+    std::error_code error;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+
+    const std::string temporary = makeTemporaryPath(path);
+    std::FILE* out = std::fopen(temporary.c_str(), "wb");
+    if (!out) return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+        && std::fwrite(surface.data(), sizeof(std::int32_t), surface.size(), out) == surface.size()
+        && std::fwrite(indices.data(), sizeof(std::uint32_t), indices.size(), out) == indices.size();
+    for (std::size_t i = 0; ok && i < indices.size(); ++i) {
+        const Chunk* chunk = tiles.getChunk(indices[i] % tiles.getChunksX(), indices[i] / tiles.getChunksX());
+        ok = std::fwrite(chunk->tiles.data(), sizeof(Tile), CHUNK_TILES, out) == CHUNK_TILES;
+    }
+    ok = (std::fclose(out) == 0) && ok;
+
+    if (ok) {
+        std::filesystem::rename(temporary, target, error); // replaces an existing file
+        ok = !error;
+    }
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+}
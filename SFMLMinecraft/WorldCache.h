@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "TileStorage.h"
+#include "WorldRandom.h"
+
+// Generated worlds saved to disk, so a repeat start with the same seed and size loads the tiles
+// instead of generating them. A file is only used when its whole key matches, so changing the
+// seed, the size or the generator makes the game regenerate (and rewrite) the world by itself.
+struct WorldCacheKey {
+    WorldSeed seed = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    std::uint32_t generatorVersion = 0;     // WORLD_GENERATOR_VERSION
+    std::uint64_t generatorFingerprint = 0; // hash of a small probe world made by generateWorld
+};
+
+// Key for a world made by generateWorld. The first call generates the probe world (a few
+// milliseconds), later calls reuse its fingerprint.
+WorldCacheKey makeWorldCacheKey(WorldSeed seed, unsigned int width, unsigned int height);
+
+// One file per seed and size inside directory; a stale file is simply overwritten
+std::string getWorldCachePath(const std::string& directory, const WorldCacheKey& key);
+
+// Reads the world through a memory mapping. Returns false and leaves tiles untouched when the
+// file is missing, truncated, holds surface rows outside the world or was written for another key.
+bool loadCachedWorld(const std::string& path, const WorldCacheKey& key, TileStorage& tiles);
+
+// Writes the loaded chunks and column surfaces. Goes through a temporary file of its own that
+// replaces the old one at the end, so a crash never leaves half a world behind and two games
+// saving at once do not write into each other's file. Creates the directory.
+bool saveCachedWorld(const std::string& path, const WorldCacheKey& key, const TileStorage& tiles);
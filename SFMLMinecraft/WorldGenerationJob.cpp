@@ -0,0 +1,186 @@
+#include "WorldGenerationJob.h"
+#include "ThreadPool.h"
+#include "World.h"
+#include "WorldCache.h"
+#include "WorldPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+WorldGenerationProgress::WorldGenerationProgress(unsigned int chunksX, unsigned int spawnChunkX)
+    : progress_columns(chunksX), progress_spawnChunkX(std::min(spawnChunkX, chunksX > 0 ? chunksX - 1 : 0))
+{
+}
+
+void WorldGenerationProgress::setStage(unsigned int index, unsigned int count, const char* label)
+{
+    for (std::atomic<std::uint8_t>& column : progress_columns) column.store(0);
+    progress_columnsDone.store(0);
+    progress_stageCount.store(std::max(count, 1u));
+    progress_stageIndex.store(index);
+    progress_label.store(label);
+}
+
+void WorldGenerationProgress::finish()
+{
+    progress_label.store("Done");
+    progress_finished.store(true);
+}
+
+void WorldGenerationProgress::markColumnDone(unsigned int cx)
+{
+    if (progress_columns[cx].exchange(1) == 0) {
+        progress_columnsDone.fetch_add(1);
+    }
+}
+
+void WorldGenerationProgress::markAllColumnsDone()
+{
+    for (unsigned int cx = 0; cx < getChunksX(); ++cx) {
+        markColumnDone(cx);
+    }
+}
+
+float WorldGenerationProgress::getFraction() const
+{
+    if (isFinished()) return 1.f;
+    const float columns = getChunksX() > 0 ? static_cast<float>(getColumnsDone()) / static_cast<float>(getChunksX()) : 0.f;
+    const float fraction = (static_cast<float>(progress_stageIndex.load()) + columns) / static_cast<float>(progress_stageCount.load());
+    return std::min(fraction, 1.f);
+}
+
+WorldGenerationJob::WorldGenerationJob(WorldSeed seed, unsigned int width, unsigned int height, unsigned int spawnX,
+    std::string cacheDirectory)
+    : job_seed(seed), job_width(width), job_height(height), job_cacheDirectory(std::move(cacheDirectory)),
+    job_progress((width + CHUNK_MASK) >> CHUNK_SHIFT, spawnX >> CHUNK_SHIFT)
+{
+}
+
+WorldGenerationJob::~WorldGenerationJob()
+{
+    if (job_thread.joinable()) job_thread.join();
+}
+
+void WorldGenerationJob::start()
+{
+    if (job_thread.joinable() || job_finished.load()) return;
+    job_thread = std::thread(&WorldGenerationJob::run, this);
+}
+
+TileStorage WorldGenerationJob::takeWorld()
+{
+    return std::move(job_world);
+}
+
+void WorldGenerationJob::takeColumns(std::vector<GeneratedColumn>& out)
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(job_columnsMutex);
+    std::swap(out, job_columns);
+}
+
+void WorldGenerationJob::handOver(unsigned int firstColumn, unsigned int lastColumn)
+{
+    // Only finished columns: the chunks around them may be half way through the stages
+    job_world = TileStorage(job_width, job_height);
+    job_handedOver.assign(job_tiles.getChunksX(), 0);
+    for (unsigned int cx = firstColumn; cx <= lastColumn && cx < job_tiles.getChunksX(); ++cx) {
+        for (unsigned int cy = 0; cy < job_tiles.getChunksY(); ++cy) {
+            if (const Chunk* chunk = job_tiles.getChunk(cx, cy)) job_world.getOrCreateChunk(cx, cy) = *chunk;
+        }
+        const unsigned int x0 = cx << CHUNK_SHIFT;
+        for (unsigned int x = x0; x < std::min(x0 + CHUNK_SIZE, job_width); ++x) {
+            job_world.setSurfaceY(x, job_tiles.getSurfaceY(x));
+        }
+        job_handedOver[cx] = 1;
+    }
+}
+
+void WorldGenerationJob::publishColumn(unsigned int cx)
+{
+    // Runs on the pool thread that finished the column; no stage writes to it any more
+    if (job_handedOver[cx]) return;
+    GeneratedColumn column;
+    column.x = cx << CHUNK_SHIFT;
+    column.width = std::min(CHUNK_SIZE, job_width - column.x);
+    column.tiles.resize(static_cast<std::size_t>(column.width) * job_height);
+    for (unsigned int y = 0; y < job_height; ++y) {
+        for (unsigned int i = 0; i < column.width; ++i) {
+            column.tiles[i + static_cast<std::size_t>(y) * column.width] = job_tiles.getTile(column.x + i, y);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(job_columnsMutex);
+    job_columns.push_back(std::move(column));
+}
+
+void WorldGenerationJob::run()
+{
+    const auto begin = std::chrono::steady_clock::now();
+    auto becomeReady = [&] {
+        job_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        job_ready.store(true);
+    };
+
+    const WorldCacheKey cacheKey = makeWorldCacheKey(job_seed, job_width, job_height);
+    const std::string cachePath = getWorldCachePath(job_cacheDirectory, cacheKey);
+    if (loadCachedWorld(cachePath, cacheKey, job_world)) {
+        job_fromCache = true;
+        job_progress.markAllColumnsDone();
+        std::cout << "Loaded cached world " << cachePath << std::endl;
+        becomeReady();
+    }
+    else {
+        job_tiles = TileStorage(job_width, job_height);
+        LiquidSettleReport settled;
+        WorldPipeline pipeline(job_tiles);
+        addWorldGenerationStages(pipeline, job_seed, &settled);
+
+        // The columns around the spawn go through every stage short of the whole-world ones first,
+        // pulling in only the neighbours the stages need, and are handed over while the rest
+        // follows stage by stage
+        const unsigned int spawnChunkX = job_progress.getSpawnChunkX();
+        const unsigned int left = spawnChunkX > SPAWN_AREA_RADIUS ? spawnChunkX - SPAWN_AREA_RADIUS : 0;
+        const unsigned int right = std::min(spawnChunkX + SPAWN_AREA_RADIUS, job_tiles.getChunksX() - 1);
+        std::size_t spawnStage = pipeline.getStageCount() - 1;
+        while (spawnStage > 0 && pipeline.getStage(spawnStage).wholeWorld) --spawnStage;
+        job_progress.setStage(0, static_cast<unsigned int>(pipeline.getStageCount()), "Generating the spawn area");
+        for (unsigned int cx = left; cx <= right; ++cx) {
+            for (unsigned int cy = 0; cy < job_tiles.getChunksY(); ++cy) pipeline.ensureChunk(cx, cy, spawnStage);
+        }
+        handOver(left, right);
+
+        // The seams inside the spawn area settle on the handed-over world, walled in at its edges.
+        // The cached world gets the seam pass over the whole world instead, which may still carry
+        // liquid across the edges of the spawn area; in the game its own simulation does that.
+        settleLiquidSeams(job_world, job_seed, left, right);
+        becomeReady();
+
+        pipeline.setColumnFinishedHandler([this](unsigned int cx) { publishColumn(cx); });
+        {
+            // Only needed while generating; the workers exit once the world is done
+            ThreadPool generationPool;
+            pipeline.runAll(&generationPool, &job_progress);
+        }
+
+        // The generator itself is silent; its report is printed here, once
+        std::cout << "World generation stages:" << std::endl;
+        pipeline.printTimings(std::cout);
+        if (settled.settled) {
+            std::cout << "Liquids settled after " << settled.ticks << " ticks: " << settled.movedCells << " moves, "
+                << settled.hardenedCells << " hardened, " << settled.restlessCells << " cells still spreading" << std::endl;
+        }
+        else {
+            std::cout << "Liquids NOT settled: gave up at the " << LIQUID_SETTLE_TICK_LIMIT << "-tick limit with "
+                << settled.unsupportedCells << " cells still over air (" << settled.movedCells << " moves, "
+                << settled.hardenedCells << " hardened)" << std::endl;
+        }
+        if (!saveCachedWorld(cachePath, cacheKey, job_tiles)) {
+            std::cerr << "Could not write world cache " << cachePath << std::endl;
+        }
+        job_tiles = TileStorage();
+    }
+
+    job_progress.finish();
+    job_finished.store(true);
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TileID.h"
+#include "TileStorage.h"
+#include "WorldRandom.h"
+
+// How far a generation has got. Written by the generating threads, readable from any thread
+// (the loading view polls it every frame). Each pipeline stage runs one chunk column at a time,
+// starting at the spawn column and working outwards, so the area around the player is ready first.
+class WorldGenerationProgress {
+public:
+    WorldGenerationProgress(unsigned int chunksX, unsigned int spawnChunkX);
+
+    unsigned int getChunksX() const { return static_cast<unsigned int>(progress_columns.size()); }
+    unsigned int getSpawnChunkX() const { return progress_spawnChunkX; }
+
+    // Starts stage index of count and clears the column flags. label must be a string literal.
+    void setStage(unsigned int index, unsigned int count, const char* label);
+    void finish(); // loaded or generated; the columns are left as they are
+    const char* getStageLabel() const { return progress_label.load(); }
+    bool isFinished() const { return progress_finished.load(); }
+
+    void markColumnDone(unsigned int cx);
+    void markAllColumnsDone();
+    bool isColumnDone(unsigned int cx) const { return progress_columns[cx].load() != 0; }
+    unsigned int getColumnsDone() const { return progress_columnsDone.load(); }
+
+    // Overall progress in [0, 1]: every stage counts the same, its share filled by columns done
+    float getFraction() const;
+
+private:
+    std::vector<std::atomic<std::uint8_t>>  progress_columns; // per chunk column, 1 once filled
+    std::atomic<unsigned int>               progress_columnsDone{ 0 };
+    std::atomic<unsigned int>               progress_stageIndex{ 0 };
+    std::atomic<unsigned int>               progress_stageCount{ 1 };
+    std::atomic<const char*>                progress_label{ "Starting" };
+    std::atomic<bool>                       progress_finished{ false };
+    unsigned int                            progress_spawnChunkX;
+};
+
+// A chunk column finished after the world was handed over
+struct GeneratedColumn {
+    unsigned int x = 0;      // first tile column
+    unsigned int width = 0;
+    std::vector<Tile> tiles; // width tiles per row, every row of the world, top to bottom
+};
+
+// Loads a world from the cache, or generates and caches it, on a thread of its own so the window
+// keeps drawing (and stays responsive) meanwhile. Generation finishes the chunk columns within
+// SPAWN_AREA_RADIUS of the spawn before anything else, and the world is ready to hand over as soon
+// as they are: the other columns are left as air, and come through takeColumns() once the rest of
+// the world is done. A world loaded from the cache is handed over whole.
+class WorldGenerationJob {
+public:
+    static constexpr unsigned int SPAWN_AREA_RADIUS = 1; // chunk columns either side of the spawn
+
+    WorldGenerationJob(WorldSeed seed, unsigned int width, unsigned int height, unsigned int spawnX,
+        std::string cacheDirectory);
+    ~WorldGenerationJob(); // waits for the thread
+
+    WorldGenerationJob(const WorldGenerationJob&) = delete;
+    WorldGenerationJob& operator=(const WorldGenerationJob&) = delete;
+
+    void start();
+    bool isReady() const { return job_ready.load(); }       // the world can be taken
+    bool isFinished() const { return job_finished.load(); } // every column generated (and cached)
+    const WorldGenerationProgress& getProgress() const { return job_progress; }
+
+    // Only once isReady(); the job holds no world afterwards
+    TileStorage takeWorld();
+    // Replaces out with the columns finished since the last call, nearest the spawn first. Their
+    // chunks in the world from takeWorld() are still all air.
+    void takeColumns(std::vector<GeneratedColumn>& out);
+    // Only once isReady(): whether chunk column cx was in the world from takeWorld(). Every column
+    // of a cached world was; the others arrive through takeColumns().
+    bool isColumnHandedOver(unsigned int cx) const { return job_handedOver.empty() || job_handedOver[cx] != 0; }
+
+    // Both only once isReady()
+    bool wasLoadedFromCache() const { return job_fromCache; }
+    double getSeconds() const { return job_seconds; } // until the world was ready
+
+private:
+    void run();
+    void handOver(unsigned int firstColumn, unsigned int lastColumn);
+    void publishColumn(unsigned int cx);
+
+    WorldSeed                       job_seed;
+    unsigned int                    job_width;
+    unsigned int                    job_height;
+    std::string                     job_cacheDirectory;
+    WorldGenerationProgress         job_progress;
+    TileStorage                     job_tiles;  // generated into; owned by the job thread
+    TileStorage                     job_world;  // what takeWorld() hands over
+    std::vector<std::uint8_t>       job_handedOver; // per chunk column, 1 if in job_world
+    bool                            job_fromCache = false;
+    double                          job_seconds = 0.0;
+    std::mutex                      job_columnsMutex;
+    std::vector<GeneratedColumn>    job_columns; // finished, waiting for takeColumns()
+    std::atomic<bool>               job_ready{ false };
+    std::atomic<bool>               job_finished{ false };
+    std::thread                     job_thread;
+};
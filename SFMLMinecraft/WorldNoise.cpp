@@ -0,0 +1,277 @@
+#include "WorldNoise.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(__AVX2__)
+#define WORLD_NOISE_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WORLD_NOISE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr unsigned int MAX_OCTAVES = 8;
+
+#if defined(WORLD_NOISE_AVX2)
+constexpr std::size_t LANES = 8;
+#elif defined(WORLD_NOISE_SSE2)
+constexpr std::size_t LANES = 4;
+#else
+constexpr std::size_t LANES = 1;
+#endif
+
+// Thomas Wang's 32-bit integer hash: shifts, adds and xors only, so SSE2 can run it too
+std::uint32_t hashLattice(std::uint32_t key) {
+    key = ~key + (key << 15);
+    key ^= key >> 12;
+    key += key << 2;
+    key ^= key >> 4;
+    key *= 2057;
+    key ^= key >> 16;
+    return key;
+}
+
+float latticeValue(std::uint32_t key) {
+    return static_cast<float>(static_cast<int>(hashLattice(key) & 0xFFFF)) * (2.0f / 65535.0f) - 1.0f;
+}
+
+float fade(float t) { return (t * t) * (3.0f - 2.0f * t); }
+float lerp(float a, float b, float s) { return a + (b - a) * s; }
+
+unsigned int octaveCount(const NoiseParams& params) {
+    return std::max(1u, std::min({ params.octaves, params.cellShift + 1, MAX_OCTAVES }));
+}
+
+// Octave amplitudes halve each octave and are scaled so they sum to one
+float octaveAmplitude(unsigned int octaves, unsigned int octave) {
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    for (unsigned int o = 0; o < octaves; ++o) {
+        sum += amplitude;
+        amplitude *= 0.5f;
+    }
+    return std::ldexp(1.0f, -static_cast<int>(octave)) * (1.0f / sum);
+}
+
+std::uint32_t octaveCounter(const NoiseParams& params, unsigned int octave) {
+    return params.variant * MAX_OCTAVES + octave;
+}
+
+std::uint32_t latticeRowKey(const NoiseParams& params, std::uint32_t counter, int latticeY) {
+    return static_cast<std::uint32_t>(randomBits({ params.seed, 0, latticeY, params.purpose, counter }));
+}
+
+// Fade weight of coordinate v inside its lattice cell
+float cellWeight(int v, unsigned int shift) {
+    const std::uint32_t mask = (1u << shift) - 1;
+    return fade(static_cast<float>(static_cast<int>(static_cast<std::uint32_t>(v) & mask)) / static_cast<float>(1u << shift));
+}
+
+// The vector code does exactly the scalar operations above, lane by lane, in the same order
+#if defined(WORLD_NOISE_AVX2)
+using IntLanes = __m256i;
+using FloatLanes = __m256;
+IntLanes laneOffsets() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+IntLanes splat(std::uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+FloatLanes splat(float v) { return _mm256_set1_ps(v); }
+IntLanes add(IntLanes a, IntLanes b) { return _mm256_add_epi32(a, b); }
+IntLanes xorLanes(IntLanes a, IntLanes b) { return _mm256_xor_si256(a, b); }
+IntLanes andLanes(IntLanes a, IntLanes b) { return _mm256_and_si256(a, b); }
+template <int N> IntLanes shiftLeft(IntLanes a) { return _mm256_slli_epi32(a, N); }
+template <int N> IntLanes shiftRight(IntLanes a) { return _mm256_srli_epi32(a, N); }
+FloatLanes toFloat(IntLanes a) { return _mm256_cvtepi32_ps(a); }
+FloatLanes add(FloatLanes a, FloatLanes b) { return _mm256_add_ps(a, b); }
+FloatLanes sub(FloatLanes a, FloatLanes b) { return _mm256_sub_ps(a, b); }
+FloatLanes mul(FloatLanes a, FloatLanes b) { return _mm256_mul_ps(a, b); }
+FloatLanes load(const float* in) { return _mm256_loadu_ps(in); }
+void store(float* out, FloatLanes a) { _mm256_storeu_ps(out, a); }
+#elif defined(WORLD_NOISE_SSE2)
+using IntLanes = __m128i;
+using FloatLanes = __m128;
+IntLanes laneOffsets() { return _mm_setr_epi32(0, 1, 2, 3); }
+IntLanes splat(std::uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+FloatLanes splat(float v) { return _mm_set1_ps(v); }
+IntLanes add(IntLanes a, IntLanes b) { return _mm_add_epi32(a, b); }
+IntLanes xorLanes(IntLanes a, IntLanes b) { return _mm_xor_si128(a, b); }
+IntLanes andLanes(IntLanes a, IntLanes b) { return _mm_and_si128(a, b); }
+template <int N> IntLanes shiftLeft(IntLanes a) { return _mm_slli_epi32(a, N); }
+template <int N> IntLanes shiftRight(IntLanes a) { return _mm_srli_epi32(a, N); }
+FloatLanes toFloat(IntLanes a) { return _mm_cvtepi32_ps(a); }
+FloatLanes add(FloatLanes a, FloatLanes b) { return _mm_add_ps(a, b); }
+FloatLanes sub(FloatLanes a, FloatLanes b) { return _mm_sub_ps(a, b); }
+FloatLanes mul(FloatLanes a, FloatLanes b) { return _mm_mul_ps(a, b); }
+FloatLanes load(const float* in) { return _mm_loadu_ps(in); }
+void store(float* out, FloatLanes a) { _mm_storeu_ps(out, a); }
+#endif
+
+#if defined(WORLD_NOISE_AVX2) || defined(WORLD_NOISE_SSE2)
+IntLanes hashLattice(IntLanes key) {
+    key = add(xorLanes(key, splat(0xFFFFFFFFu)), shiftLeft<15>(key));
+    key = xorLanes(key, shiftRight<12>(key));
+    key = add(key, shiftLeft<2>(key));
+    key = xorLanes(key, shiftRight<4>(key));
+    key = add(add(key, shiftLeft<3>(key)), shiftLeft<11>(key)); // key * 2057
+    key = xorLanes(key, shiftRight<16>(key));
+    return key;
+}
+
+FloatLanes latticeValue(IntLanes key) {
+    return sub(mul(toFloat(andLanes(hashLattice(key), splat(0xFFFFu))), splat(2.0f / 65535.0f)), splat(1.0f));
+}
+
+FloatLanes lerp(FloatLanes a, FloatLanes b, FloatLanes s) { return add(a, mul(sub(b, a), s)); }
+#endif
+
+} // namespace
+
+float sampleNoise(const NoiseParams& params, int x, int y)
+{
+    const unsigned int octaves = octaveCount(params);
+    float total = 0.0f;
+    for (unsigned int o = 0; o < octaves; ++o) {
+        const unsigned int shift = params.cellShift - o;
+        const std::uint32_t counter = octaveCounter(params, o);
+        const std::uint32_t keyAbove = latticeRowKey(params, counter, y >> shift);
+        const std::uint32_t keyBelow = latticeRowKey(params, counter, (y >> shift) + 1);
+        const std::uint32_t ix = static_cast<std::uint32_t>(x >> shift);
+        const float sy = cellWeight(y, shift);
+
+        const float left = lerp(latticeValue(keyAbove ^ ix), latticeValue(keyBelow ^ ix), sy);
+        const float right = lerp(latticeValue(keyAbove ^ (ix + 1)), latticeValue(keyBelow ^ (ix + 1)), sy);
+        const float value = lerp(left, right, cellWeight(x, shift)) * octaveAmplitude(octaves, o);
+        total = (o == 0) ? value : total + value;
+    }
+    return total;
+}
+
+NoiseStrip::NoiseStrip(const NoiseParams& params, int x, std::size_t count)
+    : noise_params(params), noise_x(x), noise_count(count)
+{
+    noise_octaves.resize(octaveCount(params));
+    for (std::size_t o = 0; o < noise_octaves.size(); ++o) {
+        Octave& octave = noise_octaves[o];
+        octave.shift = params.cellShift - static_cast<unsigned int>(o);
+        octave.amplitude = octaveAmplitude(static_cast<unsigned int>(noise_octaves.size()), static_cast<unsigned int>(o));
+        octave.firstColumn = x >> octave.shift;
+        octave.columnCount = count == 0 ? 0
+            : static_cast<std::size_t>(((x + static_cast<int>(count) - 1) >> octave.shift) - octave.firstColumn) + 2;
+
+        // Lattice rows are padded to whole vectors so the hash kernel needs no scalar tail
+        const std::size_t padded = (octave.columnCount + LANES - 1) / LANES * LANES;
+        octave.values.resize(padded * 3 + count);
+        octave.above = 0;
+        octave.below = padded;
+        octave.blended = padded * 2;
+        octave.weights = padded * 3;
+
+        // The fade repeats every lattice cell, so only the first cell's worth is computed
+        const std::size_t period = std::size_t{ 1 } << octave.shift;
+        float* weights = octave.values.data() + octave.weights;
+        for (std::size_t i = 0; i < count; ++i) {
+            weights[i] = i < period ? cellWeight(x + static_cast<int>(i), octave.shift) : weights[i - period];
+        }
+    }
+}
+
+void NoiseStrip::hashLatticeRow(const Octave& octave, std::uint32_t counter, int latticeY, float* out) const
+{
+    const std::uint32_t key = latticeRowKey(noise_params, counter, latticeY);
+    const std::uint32_t first = static_cast<std::uint32_t>(octave.firstColumn);
+#if defined(WORLD_NOISE_AVX2) || defined(WORLD_NOISE_SSE2)
+    const IntLanes keys = splat(key);
+    for (std::size_t c = 0; c < octave.columnCount; c += LANES) {
+        const IntLanes columns = add(splat(first + static_cast<std::uint32_t>(c)), laneOffsets());
+        store(out + c, latticeValue(xorLanes(keys, columns)));
+    }
+#else
+    for (std::size_t c = 0; c < octave.columnCount; ++c) {
+        out[c] = latticeValue(key ^ (first + static_cast<std::uint32_t>(c)));
+    }
+#endif
+}
+
+void NoiseStrip::sampleRow(int y, float* out)
+{
+    for (std::size_t o = 0; o < noise_octaves.size(); ++o) {
+        Octave& octave = noise_octaves[o];
+        const std::uint32_t counter = octaveCounter(noise_params, static_cast<unsigned int>(o));
+        float* values = octave.values.data();
+
+        // Rows between two lattice rows reuse their hashed values; stepping down one lattice row
+        // only hashes the new row below
+        const int latticeY = y >> octave.shift;
+        if (!octave.cached || latticeY != octave.latticeY) {
+            if (octave.cached && latticeY == octave.latticeY + 1) {
+                std::swap(octave.above, octave.below);
+            }
+            else {
+                hashLatticeRow(octave, counter, latticeY, values + octave.above);
+            }
+            hashLatticeRow(octave, counter, latticeY + 1, values + octave.below);
+            octave.latticeY = latticeY;
+            octave.cached = true;
+        }
+
+        const float sy = cellWeight(y, octave.shift);
+        const float* above = values + octave.above;
+        const float* below = values + octave.below;
+        float* blended = values + octave.blended;
+        for (std::size_t c = 0; c < octave.columnCount; ++c) {
+            blended[c] = lerp(above[c], below[c], sy);
+        }
+
+        // Samples between two lattice columns share both end values. The first octave writes
+        // out, the others add to it.
+        const float* weights = values + octave.weights;
+        const float amplitude = octave.amplitude;
+        const int period = 1 << octave.shift;
+        const int end = noise_x + static_cast<int>(noise_count);
+        for (std::size_t c = 0; c + 1 < octave.columnCount; ++c) {
+            const int start = (octave.firstColumn + static_cast<int>(c)) * period;
+            std::size_t i = static_cast<std::size_t>(std::max(start, noise_x) - noise_x);
+            const std::size_t last = static_cast<std::size_t>(std::min(start + period, end) - noise_x);
+            const float left = blended[c];
+            const float right = blended[c + 1];
+            if (o == 0) {
+#if defined(WORLD_NOISE_AVX2) || defined(WORLD_NOISE_SSE2)
+                for (; i + LANES <= last; i += LANES) {
+                    store(out + i, mul(lerp(splat(left), splat(right), load(weights + i)), splat(amplitude)));
+                }
+#endif
+                for (; i < last; ++i) {
+                    out[i] = lerp(left, right, weights[i]) * amplitude;
+                }
+            }
+            else {
+#if defined(WORLD_NOISE_AVX2) || defined(WORLD_NOISE_SSE2)
+                for (; i + LANES <= last; i += LANES) {
+                    const FloatLanes value = mul(lerp(splat(left), splat(right), load(weights + i)), splat(amplitude));
+                    store(out + i, add(load(out + i), value));
+                }
+#endif
+                for (; i < last; ++i) {
+                    out[i] = out[i] + lerp(left, right, weights[i]) * amplitude;
+                }
+            }
+        }
+    }
+}
+
+void sampleNoiseRow(const NoiseParams& params, int x, int y, std::size_t count, float* out)
+{
+    NoiseStrip(params, x, count).sampleRow(y, out);
+}
+
+const char* getNoisePath()
+{
+#if defined(WORLD_NOISE_AVX2)
+    return "AVX2";
+#elif defined(WORLD_NOISE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
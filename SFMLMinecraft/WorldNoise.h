@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WorldRandom.h"
+
+// Value noise for world generation, sampled at whole tile coordinates. Lattice values come from
+// an integer hash and the lattice spacing is a power of two, so a sample is exact integer work
+// plus a few float lerps: the same (params, x, y) gives the same value on every path and platform.
+struct NoiseParams {
+    WorldSeed seed;
+    RandomPurpose purpose;
+    std::uint32_t variant = 0;   // independent noise fields for the same purpose
+    unsigned int cellShift = 4;  // first octave has a lattice point every 1 << cellShift tiles
+    unsigned int octaves = 1;    // each further octave halves spacing and amplitude
+};
+
+// Noise at (x, y), in [-1, 1]
+float sampleNoise(const NoiseParams& params, int x, int y);
+
+// One noise field over the columns [x, x + count), sampled row after row. Lattice values are
+// hashed 8 (AVX2) or 4 (SSE2) at a time when the compiler targets those, once per lattice row,
+// and shared by every sample between two lattice points, so walking down a strip costs a couple
+// of multiply-adds per sample and octave.
+class NoiseStrip {
+public:
+    NoiseStrip(const NoiseParams& params, int x, std::size_t count);
+
+    // out[i] = sampleNoise(params, x + i, y) for i in [0, count). Fastest when y only grows.
+    void sampleRow(int y, float* out);
+
+    std::size_t getCount() const { return noise_count; }
+
+private:
+    struct Octave {
+        unsigned int shift;
+        float amplitude;              // already scaled so the octave sum stays in [-1, 1]
+        int firstColumn;
+        std::size_t columnCount;
+        int latticeY = 0;             // lattice row held in above; below is the one after it
+        bool cached = false;
+        // One allocation per octave, split into the lattice rows above and below y, the lattice
+        // columns blended between them for y, and the horizontal fade per sample (the same on
+        // every row). Offsets rather than pointers, so strips can be copied and moved.
+        std::vector<float> values;
+        std::size_t above;
+        std::size_t below;
+        std::size_t blended;
+        std::size_t weights;
+    };
+
+    void hashLatticeRow(const Octave& octave, std::uint32_t counter, int latticeY, float* out) const;
+
+    NoiseParams         noise_params;
+    int                 noise_x;
+    std::size_t         noise_count;
+    std::vector<Octave> noise_octaves;
+};
+
+// out[i] = sampleNoise(params, x + i, y) for i in [0, count), for one-off rows
+void sampleNoiseRow(const NoiseParams& params, int x, int y, std::size_t count, float* out);
+
+// Name of the code path picked at compile time ("AVX2", "SSE2" or "scalar"), for benchmarks
+const char* getNoisePath();
@@ -0,0 +1,209 @@
+#include "WorldPipeline.h"
+#include "ThreadPool.h"
+#include "WorldGenerationJob.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t nanosecondsSince(Clock::time_point start) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+} // namespace
+
+WorldPipeline::WorldPipeline(TileStorage& tiles)
+    : pipe_tiles(tiles), pipe_chunksX(tiles.getChunksX()), pipe_chunksY(tiles.getChunksY()),
+    pipe_done(static_cast<std::size_t>(tiles.getChunksX()) * tiles.getChunksY(), 0)
+{
+}
+
+std::size_t WorldPipeline::addStage(GenerationStage stage)
+{
+    pipe_stages.push_back(std::move(stage));
+    pipe_timings.emplace_back();
+    pipe_prepared.push_back(0);
+    return pipe_stages.size() - 1;
+}
+
+int WorldPipeline::findStage(const char* name) const
+{
+    for (std::size_t i = 0; i < pipe_stages.size(); ++i) {
+        if (std::strcmp(pipe_stages[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::size_t WorldPipeline::getCompletedStages(unsigned int cx, unsigned int cy) const
+{
+    return pipe_done[chunkIndex(cx, cy)];
+}
+
+void WorldPipeline::ensureChunk(unsigned int cx, unsigned int cy, std::size_t stage)
+{
+    if (cx >= pipe_chunksX || cy >= pipe_chunksY || pipe_stages.empty()) return;
+    stage = std::min(stage, pipe_stages.size() - 1);
+
+    // A neighbour may pull this chunk through a whole-column stage, so re-read after every step
+    for (std::size_t next = getCompletedStages(cx, cy); next <= stage; next = getCompletedStages(cx, cy)) {
+        const GenerationStage& current = pipe_stages[next];
+        if (current.wholeWorld) {
+            for (unsigned int y = 0; next > 0 && y < pipe_chunksY; ++y) {
+                for (unsigned int x = 0; x < pipe_chunksX; ++x) ensureChunk(x, y, next - 1);
+            }
+            runWorldStage(next);
+            continue;
+        }
+        const unsigned int r = static_cast<unsigned int>(std::max(current.neighbourRadius, 0));
+        if (next > 0 && (r > 0 || current.wholeColumn)) {
+            const unsigned int left = cx > r ? cx - r : 0, right = std::min(cx + r, pipe_chunksX - 1);
+            unsigned int top = 0, bottom = pipe_chunksY - 1;
+            if (!current.wholeColumn) {
+                top = cy > r ? cy - r : 0;
+                bottom = std::min(cy + r, pipe_chunksY - 1);
+            }
+            for (unsigned int y = top; y <= bottom; ++y) {
+                for (unsigned int x = left; x <= right; ++x) ensureChunk(x, y, next - 1);
+            }
+        }
+        prepareStage(next);
+        if (current.wholeColumn) {
+            runColumnStage(next, cx);
+        }
+        else {
+            runChunkStage(next, cx, cy);
+        }
+    }
+}
+
+void WorldPipeline::runThrough(std::size_t lastStage, ThreadPool* pool, WorldGenerationProgress* progress)
+{
+    if (pipe_stages.empty()) return;
+    lastStage = std::min(lastStage, pipe_stages.size() - 1);
+
+    // Nearest the spawn first, so a progress display fills in around the player
+    std::vector<unsigned int> columns(pipe_chunksX);
+    for (unsigned int cx = 0; cx < pipe_chunksX; ++cx) columns[cx] = cx;
+    if (progress) {
+        const int spawn = static_cast<int>(progress->getSpawnChunkX());
+        std::stable_sort(columns.begin(), columns.end(), [spawn](unsigned int a, unsigned int b) {
+            return std::abs(static_cast<int>(a) - spawn) < std::abs(static_cast<int>(b) - spawn);
+        });
+    }
+
+    // Stage by stage, so whatever a chunk stage reads has finished the previous stage everywhere.
+    // Chunks generated earlier by ensureChunk are simply skipped.
+    for (std::size_t stage = 0; stage <= lastStage; ++stage) {
+        const GenerationStage& current = pipe_stages[stage];
+        if (progress) progress->setStage(static_cast<unsigned int>(stage), static_cast<unsigned int>(pipe_stages.size()), current.label);
+
+        if (current.wholeWorld) {
+            if (!pipe_done.empty() && pipe_done[0] <= stage) runWorldStage(stage);
+            if (progress) progress->markAllColumnsDone();
+            if (stage + 1 == pipe_stages.size() && pipe_columnFinished) {
+                for (unsigned int cx : columns) pipe_columnFinished(cx);
+            }
+            continue;
+        }
+
+        prepareStage(stage);
+        auto runColumn = [&](unsigned int cx) {
+            if (current.wholeColumn) {
+                if (pipe_chunksY > 0 && getCompletedStages(cx, 0) <= stage) runColumnStage(stage, cx);
+            }
+            else {
+                for (unsigned int cy = 0; cy < pipe_chunksY; ++cy) {
+                    if (getCompletedStages(cx, cy) <= stage) runChunkStage(stage, cx, cy);
+                }
+            }
+            if (progress) progress->markColumnDone(cx);
+            if (stage + 1 == pipe_stages.size() && pipe_columnFinished) pipe_columnFinished(cx);
+        };
+        if (pool && pool->getThreadCount() > 1 && columns.size() > 1) {
+            pool->parallelFor(columns.size(), [&](std::size_t i) { runColumn(columns[i]); });
+        }
+        else {
+            for (unsigned int cx : columns) runColumn(cx);
+        }
+    }
+}
+
+GenerationStageTiming WorldPipeline::getTiming(std::size_t stage) const
+{
+    GenerationStageTiming timing;
+    timing.seconds = static_cast<double>(pipe_timings[stage].nanoseconds.load()) * 1e-9;
+    timing.runs = pipe_timings[stage].runs.load();
+    return timing;
+}
+
+void WorldPipeline::printTimings(std::ostream& out) const
+{
+    double total = 0.0;
+    for (std::size_t i = 0; i < pipe_stages.size(); ++i) {
+        const GenerationStageTiming timing = getTiming(i);
+        total += timing.seconds;
+        out << "  " << std::left << std::setw(12) << pipe_stages[i].name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(9) << timing.seconds * 1000.0 << " ms  " << timing.runs
+            << (pipe_stages[i].wholeWorld ? " world" : pipe_stages[i].wholeColumn ? " columns" : " chunks")
+            << (pipe_stages[i].enabled ? "" : " (skipped)") << '\n';
+    }
+    out << "  " << std::left << std::setw(12) << "total" << std::right << std::setw(9) << total * 1000.0 << " ms"
+        << std::defaultfloat << std::endl;
+}
+
+void WorldPipeline::prepareStage(std::size_t stage)
+{
+    if (pipe_prepared[stage]) return;
+    pipe_prepared[stage] = 1;
+    const GenerationStage& current = pipe_stages[stage];
+    if (!current.enabled || !current.prepare) return;
+
+    const auto start = Clock::now();
+    current.prepare(pipe_tiles);
+    pipe_timings[stage].nanoseconds.fetch_add(nanosecondsSince(start));
+}
+
+void WorldPipeline::runChunkStage(std::size_t stage, unsigned int cx, unsigned int cy)
+{
+    const GenerationStage& current = pipe_stages[stage];
+    if (current.enabled && current.runChunk) {
+        const auto start = Clock::now();
+        current.runChunk(pipe_tiles, cx, cy);
+        pipe_timings[stage].nanoseconds.fetch_add(nanosecondsSince(start));
+        pipe_timings[stage].runs.fetch_add(1);
+    }
+    pipe_done[chunkIndex(cx, cy)] = static_cast<std::uint8_t>(stage + 1);
+}
+
+void WorldPipeline::runColumnStage(std::size_t stage, unsigned int cx)
+{
+    const GenerationStage& current = pipe_stages[stage];
+    if (current.enabled && current.runColumn) {
+        const auto start = Clock::now();
+        current.runColumn(pipe_tiles, cx);
+        pipe_timings[stage].nanoseconds.fetch_add(nanosecondsSince(start));
+        pipe_timings[stage].runs.fetch_add(1);
+    }
+    for (unsigned int cy = 0; cy < pipe_chunksY; ++cy) {
+        pipe_done[chunkIndex(cx, cy)] = static_cast<std::uint8_t>(stage + 1);
+    }
+}
+
+void WorldPipeline::runWorldStage(std::size_t stage)
+{
+    const GenerationStage& current = pipe_stages[stage];
+    prepareStage(stage);
+    if (current.enabled && current.runWorld) {
+        const auto start = Clock::now();
+        current.runWorld(pipe_tiles);
+        pipe_timings[stage].nanoseconds.fetch_add(nanosecondsSince(start));
+        pipe_timings[stage].runs.fetch_add(1);
+    }
+    std::fill(pipe_done.begin(), pipe_done.end(), static_cast<std::uint8_t>(stage + 1));
+}
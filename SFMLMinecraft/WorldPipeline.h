@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+#include "TileStorage.h"
+
+class ThreadPool;
+class WorldGenerationProgress;
+
+// One step of world generation. Most stages work on one chunk at a time: runChunk may write only
+// to its own chunk, and may read the chunks within neighbourRadius of it (a square, in chunks),
+// which are guaranteed to have finished the previous stage. Stages that follow something down
+// through any number of chunks (falling liquid) set wholeColumn and provide runColumn instead: it
+// may write only to chunk column cx, and every chunk of the columns within neighbourRadius of it
+// has finished the previous stage. A stage that has to see the whole world at once sets
+// wholeWorld and provides runWorld; keep such stages last, since taking any chunk through one
+// takes every chunk through everything before it.
+struct GenerationStage {
+    const char* name = "";  // short, for lookups and the timing report
+    const char* label = ""; // shown while loading
+    int neighbourRadius = 0;
+    bool wholeColumn = false;
+    bool wholeWorld = false;
+
+    // Optional, called once before the stage first runs. Must not read tiles: it sees whatever
+    // happens to be generated at that moment.
+    std::function<void(TileStorage&)> prepare;
+    std::function<void(TileStorage&, unsigned int cx, unsigned int cy)> runChunk;
+    std::function<void(TileStorage&, unsigned int cx)> runColumn;
+    std::function<void(TileStorage&)> runWorld;
+
+    bool enabled = true; // a disabled stage counts as done without running
+};
+
+struct GenerationStageTiming {
+    double seconds = 0.0;  // summed over all runs, on all threads
+    unsigned int runs = 0; // chunks, columns for a whole-column stage, 1 for a whole-world stage
+};
+
+// Ordered generation stages over one world, run lazily: ensureChunk() generates a chunk only as
+// far as asked, pulling its neighbours along as far as the stage dependencies require, so the
+// area around the player can be finished before anything else is touched. Each chunk records how
+// many stages it has been through, and each stage how long it took.
+class WorldPipeline {
+public:
+    explicit WorldPipeline(TileStorage& tiles);
+
+    WorldPipeline(const WorldPipeline&) = delete;
+    WorldPipeline& operator=(const WorldPipeline&) = delete;
+
+    // Stages run in the order they are added; add them all before running any
+    std::size_t addStage(GenerationStage stage);
+    std::size_t getStageCount() const { return pipe_stages.size(); }
+    const GenerationStage& getStage(std::size_t stage) const { return pipe_stages[stage]; }
+    int findStage(const char* name) const; // -1 if there is none
+    void setStageEnabled(std::size_t stage, bool enabled) { pipe_stages[stage].enabled = enabled; }
+
+    // Stages chunk (cx, cy) has been through
+    std::size_t getCompletedStages(unsigned int cx, unsigned int cy) const;
+
+    // Runs chunk (cx, cy) through every stage up to and including stage (all of them by default).
+    // Serial; the world stays consistent between calls, so chunks can be generated as needed.
+    void ensureChunk(unsigned int cx, unsigned int cy, std::size_t stage);
+    void ensureChunk(unsigned int cx, unsigned int cy) { ensureChunk(cx, cy, pipe_stages.size() - 1); }
+
+    // Runs every chunk through stage lastStage, one stage after the other. With a pool each stage
+    // runs one chunk column per task: a column's chunks are generated top to bottom by the same
+    // task (or all at once by a whole-column stage), and every neighbour a stage reads has
+    // finished the previous stage already.
+    // With progress the columns are handed out from its spawn column outwards and reported.
+    void runThrough(std::size_t lastStage, ThreadPool* pool = nullptr, WorldGenerationProgress* progress = nullptr);
+    void runAll(ThreadPool* pool = nullptr, WorldGenerationProgress* progress = nullptr) {
+        runThrough(pipe_stages.size() - 1, pool, progress);
+    }
+
+    // Called by runThrough each time it has taken a chunk column through the last stage (columns
+    // ensureChunk finished earlier included), on the thread that ran the column, or for every
+    // column in turn once a last whole-world stage is done. The column's tiles are final from then
+    // on: no later stage run writes to them.
+    void setColumnFinishedHandler(std::function<void(unsigned int cx)> handler) { pipe_columnFinished = std::move(handler); }
+
+    GenerationStageTiming getTiming(std::size_t stage) const;
+    // One line per stage: name, milliseconds, runs
+    void printTimings(std::ostream& out) const;
+
+private:
+    struct Timing {
+        std::atomic<std::uint64_t> nanoseconds{ 0 };
+        std::atomic<unsigned int> runs{ 0 };
+    };
+
+    std::size_t chunkIndex(unsigned int cx, unsigned int cy) const { return cx + static_cast<std::size_t>(cy) * pipe_chunksX; }
+    void prepareStage(std::size_t stage);
+    void runChunkStage(std::size_t stage, unsigned int cx, unsigned int cy);
+    void runColumnStage(std::size_t stage, unsigned int cx);
+    void runWorldStage(std::size_t stage);
+
+    TileStorage&                    pipe_tiles;
+    unsigned int                    pipe_chunksX;
+    unsigned int                    pipe_chunksY;
+    std::vector<GenerationStage>    pipe_stages;
+    std::deque<Timing>              pipe_timings;  // deque: atomics cannot be moved
+    std::vector<std::uint8_t>       pipe_prepared; // per stage
+    std::vector<std::uint8_t>       pipe_done;     // completed stages per chunk, cx + cy * chunksX
+    std::function<void(unsigned int)> pipe_columnFinished;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+// Seedable, stateless, counter-based random numbers for world generation and simulation.
+// Every draw is a pure function of (seed, x, y, purpose, counter), so any column, chunk or
+// cell can be generated independently, in any order and on any thread, with identical results
+// on every platform (unlike std::rand, whose sequence and global state are implementation defined).
+
+using WorldSeed = std::uint64_t;
+
+// What a draw is used for. Different purposes at the same coordinates give unrelated values.
+enum class RandomPurpose : std::uint32_t {
+    SurfaceHeight,
+    DirtDepth,
+    Ore,
+    SurfaceWaterPool,
+    LavaPool,
+    WaterCave,
+    Tree,
+    Plant,
+    WaterFlow,
+    LavaSpread,
+    LavaFlow,
+    Cave,
+    OreVein
+};
+
+struct RandomKey {
+    WorldSeed seed;
+    int x;
+    int y;
+    RandomPurpose purpose;
+    std::uint32_t counter = 0; // n-th draw for the same key, or simulation tick
+};
+
+// SplitMix64 finaliser
+constexpr std::uint64_t mixRandom64(std::uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr std::uint64_t randomBits(const RandomKey& key) {
+    std::uint64_t position = static_cast<std::uint32_t>(key.x) | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.y)) << 32);
+    std::uint64_t stream = static_cast<std::uint32_t>(key.purpose) | (static_cast<std::uint64_t>(key.counter) << 32);
+    return mixRandom64(mixRandom64(mixRandom64(key.seed) ^ position) ^ stream);
+}
+
+// Uniform integer in [min, max] (inclusive), without modulo bias
+constexpr int randomInt(const RandomKey& key, int min, int max) {
+    std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min + 1);
+    std::uint64_t bits = randomBits(key) >> 32;
+    return min + static_cast<int>((bits * range) >> 32);
+}
+
+static_assert(randomInt({ 1, 2, 3, RandomPurpose::Ore }, 5, 5) == 5, "degenerate range");
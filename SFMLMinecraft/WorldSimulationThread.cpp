@@ -0,0 +1,111 @@
+#include "WorldSimulationThread.h"
+#include <chrono>
+
+WorldSimulationThread::WorldSimulationThread(const TileStorage& world, WorldSeed seed, float ticksPerSecond)
+    : worker_tiles(world.clone()), worker_liquids(seed),
+    // The thread has nothing else to do, so the frame budget is just a safety net
+    worker_scheduler(ticksPerSecond, 1000.f / ticksPerSecond) {
+    worker_liquids.reset(worker_tiles);
+}
+
+WorldSimulationThread::~WorldSimulationThread()
+{
+    stop();
+}
+
+void WorldSimulationThread::start()
+{
+    if (worker_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        worker_stop = false;
+    }
+    worker_thread = std::thread(&WorldSimulationThread::run, this);
+}
+
+void WorldSimulationThread::stop()
+{
+    if (!worker_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        worker_stop = true;
+    }
+    worker_wake.notify_all();
+    worker_thread.join();
+}
+
+void WorldSimulationThread::postEdit(unsigned int x, unsigned int y, Tile tile)
+{
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    worker_inbound.push_back({ x, y, tile });
+}
+
+void WorldSimulationThread::postEdits(const std::vector<TileEdit>& edits)
+{
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    worker_inbound.insert(worker_inbound.end(), edits.begin(), edits.end());
+}
+
+void WorldSimulationThread::takeChanges(std::vector<TileEdit>& out)
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    // Swapping hands the old buffer back for reuse, so neither side allocates in steady state
+    std::swap(out, worker_published);
+}
+
+WorldTickStats WorldSimulationThread::getStats() const
+{
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    return worker_stats;
+}
+
+void WorldSimulationThread::run()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration<float>(1.f / worker_scheduler.getTicksPerSecond());
+    Clock::time_point last = Clock::now();
+
+    for (;;) {
+        const Clock::time_point now = Clock::now();
+        const float deltaTime = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        worker_scheduler.update(deltaTime, [this] { tick(); });
+
+        std::unique_lock<std::mutex> lock(worker_mutex);
+        worker_stats = worker_scheduler.getStats();
+        if (worker_wake.wait_until(lock, now + std::chrono::duration_cast<Clock::duration>(period),
+            [this] { return worker_stop; })) {
+            return;
+        }
+    }
+}
+
+void WorldSimulationThread::tick()
+{
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        std::swap(worker_edits, worker_inbound);
+    }
+    for (const TileEdit& edit : worker_edits) {
+        worker_tiles.setTile(edit.x, edit.y, edit.tile);
+        worker_liquids.wake(edit.x, edit.y);
+    }
+
+    worker_liquids.step(worker_tiles);
+
+    const unsigned int width = worker_tiles.getWidth();
+    std::lock_guard<std::mutex> lock(worker_mutex);
+    // Echo the game's own edits: a change published before this tick saw them may have
+    // overwritten them on the game side, and this puts the authoritative value back
+    for (const TileEdit& edit : worker_edits) {
+        worker_published.push_back({ edit.x, edit.y, worker_tiles.getTile(edit.x, edit.y) });
+    }
+    for (std::uint32_t cell : worker_liquids.getChangedCells()) {
+        const unsigned int x = cell % width;
+        const unsigned int y = cell / width;
+        worker_published.push_back({ x, y, worker_tiles.getTile(x, y) });
+    }
+    worker_edits.clear();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "LiquidSimulator.h"
+#include "TileStorage.h"
+#include "WorldRandom.h"
+#include "WorldTickScheduler.h"
+
+// Runs world ticks (liquids, later other block updates) on a thread of its own so a slow tick
+// never holds up a rendered frame.
+// The thread simulates its own copy of the world and is the authority on it. After every tick
+// it publishes the cells that changed; the game thread collects them once per frame with
+// takeChanges(). Both sides only hold the lock to append to or swap a change list, so neither
+// waits for the other's work. Edits made by the game (mining, placing) are posted back with
+// postEdit() and applied before the next tick, then echoed in the published changes.
+class WorldSimulationThread {
+public:
+    WorldSimulationThread(const TileStorage& world, WorldSeed seed, float ticksPerSecond = 20.f);
+    ~WorldSimulationThread(); // stops the thread
+
+    WorldSimulationThread(const WorldSimulationThread&) = delete;
+    WorldSimulationThread& operator=(const WorldSimulationThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Game thread: the game changed a tile
+    void postEdit(unsigned int x, unsigned int y, Tile tile);
+    void postEdits(const std::vector<TileEdit>& edits);
+
+    // Game thread: replaces out with every change published since the last call, oldest first.
+    // The same cell may appear more than once; the last entry wins.
+    void takeChanges(std::vector<TileEdit>& out);
+
+    WorldTickStats getStats() const;
+
+private:
+    void run();
+    void tick();
+
+    // Owned by the simulation thread while it runs
+    TileStorage                 worker_tiles;
+    LiquidSimulator             worker_liquids;
+    WorldTickScheduler          worker_scheduler;
+    std::vector<TileEdit>       worker_edits;     // inbound edits being applied this tick
+
+    std::thread                 worker_thread;
+    mutable std::mutex          worker_mutex;
+    std::condition_variable     worker_wake;
+    bool                        worker_stop = false;
+    std::vector<TileEdit>       worker_inbound;   // posted by the game thread
+    std::vector<TileEdit>       worker_published; // waiting for takeChanges()
+    WorldTickStats              worker_stats;
+};
@@ -0,0 +1,53 @@
+#include "WorldTickScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+WorldTickScheduler::WorldTickScheduler(float ticksPerSecond, float budgetMs, std::uint32_t maxBacklog)
+    : sched_period(1.f / ticksPerSecond), sched_budgetMs(budgetMs), sched_maxBacklog(maxBacklog) {
+}
+
+void WorldTickScheduler::setTicksPerSecond(float ticksPerSecond)
+{
+    sched_period = 1.f / ticksPerSecond;
+}
+
+std::uint32_t WorldTickScheduler::update(float deltaTime, const std::function<void()>& tick)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    sched_accumulator += std::max(deltaTime, 0.f);
+    std::uint32_t due = static_cast<std::uint32_t>(sched_accumulator / sched_period);
+
+    // Too far behind to ever catch up: drop the oldest ticks instead of stalling the frame loop
+    if (due > sched_maxBacklog) {
+        const std::uint32_t dropped = due - sched_maxBacklog;
+        sched_stats.ticksSkipped += dropped;
+        sched_accumulator -= dropped * sched_period;
+        sched_carried -= std::min(sched_carried, dropped);
+        due = sched_maxBacklog;
+    }
+
+    std::uint32_t ran = 0;
+    while (ran < due) {
+        if (ran > 0) {
+            const float elapsedMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            if (elapsedMs >= sched_budgetMs) break;
+        }
+
+        tick();
+        sched_accumulator -= sched_period;
+        ++ran;
+        // Carried-over ticks are the oldest, so they run first
+        if (sched_carried > 0) {
+            --sched_carried;
+            ++sched_stats.ticksLate;
+        }
+    }
+
+    sched_carried = due - ran;
+    sched_stats.ticksRun += ran;
+    sched_stats.backlog = sched_carried;
+    sched_stats.lastUpdateMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    return ran;
+}
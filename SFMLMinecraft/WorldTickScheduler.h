@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// Counters since the scheduler was created
+struct WorldTickStats {
+    std::uint64_t ticksRun = 0;
+    std::uint64_t ticksLate = 0;     // ran in a later frame than the one they became due in
+    std::uint64_t ticksSkipped = 0;  // dropped because the backlog grew past maxBacklog
+    std::uint32_t backlog = 0;       // due ticks carried over to the next frame
+    float lastUpdateMs = 0.f;        // time spent ticking in the last update()
+};
+
+// Runs world ticks at a fixed rate from a variable-rate frame loop. Every frame update() adds the
+// frame time and runs the ticks that are due, but stops once the frame's millisecond budget is
+// used up; the rest are carried over to the next frame (and counted as late when they run).
+// If the world cannot keep up at all, ticks beyond maxBacklog are dropped and counted as skipped,
+// so a slow tick never snowballs into ever longer frames.
+class WorldTickScheduler {
+public:
+    explicit WorldTickScheduler(float ticksPerSecond = 20.f, float budgetMs = 4.f, std::uint32_t maxBacklog = 10);
+
+    // Advances by deltaTime seconds and calls tick() once per tick run. At least one due tick
+    // runs per frame even if it alone is over budget, so the world always makes progress.
+    // Returns the number of ticks run.
+    std::uint32_t update(float deltaTime, const std::function<void()>& tick);
+
+    void setTicksPerSecond(float ticksPerSecond);
+    float getTicksPerSecond() const { return 1.f / sched_period; }
+    void setBudgetMs(float budgetMs) { sched_budgetMs = budgetMs; }
+    float getBudgetMs() const { return sched_budgetMs; }
+
+    const WorldTickStats& getStats() const { return sched_stats; }
+
+private:
+    float           sched_period;        // seconds per tick
+    float           sched_budgetMs;
+    std::uint32_t   sched_maxBacklog;
+    float           sched_accumulator = 0.f;
+    std::uint32_t   sched_carried = 0;   // due ticks left over from earlier frames
+    WorldTickStats  sched_stats;
+};
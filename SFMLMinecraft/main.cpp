@@ -1,27 +1,72 @@
 ﻿#include "TileMap.h"
 #include "TileID.h"
 #include "World.h"
+#include "WorldGenerationJob.h"
 #include "Character.h"
 #include "CollisionManager.h"
 #include "ActionManager.h"
 #include "Inventory.h"
 #include "InventroyPanel.h"
+#include "FrameProfiler.h"
+#include "LoadingView.h"
+#include "ProfilerOverlay.h"
+#include "WorldSimulationThread.h"
+#include <cstdlib>
+#include <iostream>
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Startup timing: time to first frame (loading view up) and to interactive (first game frame)
+    sf::Clock startupClock;
+    float timeToFirstFrameMs = -1.f;
+
     sf::RenderWindow window(sf::VideoMode({ 800u, 600u }), "2D Minecraft");
     window.setFramerateLimit(60);
 
+    sf::Font font;
+    bool fontLoaded = font.openFromFile("assets/font.ttf");
+    if (!fontLoaded) {
+        std::cout << "Font yüklenemedi, miktar yazıları olmadan devam ediliyor." << std::endl;
+    }
+
     const unsigned int width = 100u;
     const unsigned int height = 60u;
     const sf::Vector2u tileSize(46u, 46u);
 
-    std::vector<int> tiles(width * height, TILE_AIR);
-
     // --- World generation ---
-    generateCleanTerrainWithLiquids(tiles, width, height);
-    generateNiceTrees(tiles, width, height);
-    generateSimpleDetails(tiles, width, height);
+    // Same seed -> same world. Pass a number on the command line to pick another one.
+    WorldSeed worldSeed = 1;
+    if (argc > 1) {
+        worldSeed = std::strtoull(argv[1], nullptr, 10);
+    }
+    std::cout << "World seed: " << worldSeed << std::endl;
+
+    // Generated (or loaded from the cache) on a thread of its own while the loading view is shown.
+    // Once the columns around the spawn are done the world is handed to the TileMap below (main
+    // keeps no copy of its own), and the rest of it is streamed in as it finishes.
+    const sf::Vector2f spawnPosition(150.f, 100.f);
+    WorldGenerationJob generation(worldSeed, width, height,
+        static_cast<unsigned int>(spawnPosition.x) / tileSize.x, "worldcache");
+    generation.start();
+
+    LoadingView loadingView(fontLoaded ? &font : nullptr);
+    while (!generation.isReady()) {
+        while (const std::optional<sf::Event> ev = window.pollEvent()) {
+            if (ev->is<sf::Event::Closed>()) {
+                window.close();
+            }
+        }
+        if (!window.isOpen()) {
+            return 0; // the job's destructor waits for the generation thread
+        }
+
+        loadingView.draw(window, generation.getProgress());
+        window.display();
+        if (timeToFirstFrameMs < 0.f) timeToFirstFrameMs = startupClock.getElapsedTime().asSeconds() * 1000.f;
+    }
+    TileStorage tiles = generation.takeWorld();
+    std::cout << (generation.wasLoadedFromCache() ? "World loaded in " : "Spawn area generated in ")
+        << generation.getSeconds() * 1000.0 << " ms" << std::endl;
 
     // --- Character ---
     sf::Texture characterTexture;
@@ -31,15 +76,27 @@ int main() {
     }
 
     Character character(characterTexture);
-    character.setPosition(150.f, 100.f);
+    character.setPosition(spawnPosition.x, spawnPosition.y);
 
     // --- TileMap ---
     TileMap map;
-    if (!map.load("assets/tileset.png", tileSize, tiles, width, height)) {
+    if (!map.load("assets/tileset.png", tileSize, std::move(tiles))) {
         std::cout << "Tileset failed to load! Check tileset file." << std::endl;
         return -1;
     }
 
+    // --- World Simulation ---
+    // Liquids tick at a fixed 20 per second on their own thread; the map pulls in the results each frame
+    WorldSimulationThread simulation(map.getTiles(), worldSeed, 20.f);
+    map.setSimulationThread(&simulation);
+    simulation.start();
+    std::uint64_t reportedSkipped = 0;
+    std::vector<GeneratedColumn> generatedColumns;
+    bool worldStreaming = true;
+    // Chunk columns the player may edit: a column still being generated would overwrite the edit
+    std::vector<std::uint8_t> columnArrived(map.getTiles().getChunksX());
+    for (unsigned int cx = 0; cx < columnArrived.size(); ++cx) columnArrived[cx] = generation.isColumnHandedOver(cx);
+
     // --- Inventory System ---
     Inventory playerInventory;
     playerInventory.updateSprites(map.getTileSet(), tileSize);
@@ -58,35 +115,9 @@ int main() {
     int prevSelectedSlot = playerInventory.getSelectedSlot();
 
 
-    sf::Font font;
-    if (!font.openFromFile("assets/font.ttf")) {
-        std::cout << "Font yüklenemedi, miktar yazıları olmadan devam ediliyor." << std::endl;
-    }
-
     // --- View (Camera) ---
     sf::View view(window.getDefaultView());
 
-    // --- Solid & Breakable tiles ---
-    std::vector<int> solidTiles = {
-        TILE_STONE, TILE_DIRT, TILE_GRASS, TILE_PLANKS, TILE_BRICKS,
-        TILE_TNT, TILE_COBBLESTONE, TILE_BEDROCK, TILE_SAND, TILE_LOG,
-        TILE_IRON_BLOCK, TILE_GOLD_BLOCK, TILE_DIAMOND_BLOCK, TILE_CHEST,
-        TILE_COAL_ORE, TILE_IRON_ORE, TILE_BOOKSHELF, TILE_MOSSY_COBBLESTONE,
-        TILE_OBSIDIAN, TILE_FURNACE, TILE_DIAMOND_ORE, TILE_RUBY_ORE,
-        TILE_CRAFTING_TABLE, TILE_PUMPKIN, TILE_DARK_LOG, TILE_WHITE_LOG,
-        TILE_MELON, TILE_CAKE, TILE_LAPIS_BLOCK, TILE_LAPIS_ORE,
-        TILE_ENCHANTING_TABLE, TILE_LEAVES
-    };
-
-    std::vector<int> breakableTiles = {
-        TILE_STONE, TILE_DIRT, TILE_GRASS, TILE_COBBLESTONE, TILE_COAL_ORE,
-        TILE_IRON_ORE, TILE_DIAMOND_ORE, TILE_RUBY_ORE, TILE_LAPIS_ORE,
-        TILE_LOG, TILE_DARK_LOG, TILE_WHITE_LOG, TILE_LEAVES, TILE_SAND,
-        TILE_BOOKSHELF, TILE_PLANKS, TILE_TNT, TILE_MOSSY_COBBLESTONE,
-        TILE_OBSIDIAN, TILE_FURNACE, TILE_CRAFTING_TABLE, TILE_PUMPKIN,
-        TILE_MELON, TILE_CAKE, TILE_ENCHANTING_TABLE
-    };
-
     // --- Selection Box ---
     sf::RectangleShape selectionBox(sf::Vector2f(static_cast<float>(tileSize.x),
         static_cast<float>(tileSize.y)));
@@ -98,14 +129,21 @@ int main() {
     ActionManager actionManager(3.0f);
     ActionManager::Progress miningProgress;
 
+    // --- Frame Profiler (F3: overlay, F4: export CSV + Chrome trace) ---
+    FrameProfiler profiler;
+    ProfilerOverlay profilerOverlay(fontLoaded ? &font : nullptr);
+
     sf::Clock clock;
     bool wasMousePressed = false;
+    bool startupReported = false;
 
     // --- Game Loop ---
     while (window.isOpen()) {
         float deltaTime = clock.restart().asSeconds();
+        profiler.beginFrame();
 
         // --- Event Handling ---
+        profiler.beginPhase(FramePhase::Events);
         while (const std::optional<sf::Event> ev = window.pollEvent()) {
             if (ev->is<sf::Event::Closed>()) {
                 window.close();
@@ -124,6 +162,16 @@ int main() {
                     playerInventory.setSelectedSlot(slot);
                 }
 
+                if (key == sf::Keyboard::Key::F3) {
+                    profilerOverlay.toggle();
+                }
+                if (key == sf::Keyboard::Key::F4) {
+                    bool exported = profiler.exportCsv("profile_frames.csv") &&
+                        profiler.exportChromeTrace("profile_trace.json");
+                    std::cout << (exported ? "Profile written to profile_frames.csv and profile_trace.json"
+                        : "Failed to write profile files") << std::endl;
+                }
+
             }
 
             // Mouse click inventory interaction
@@ -134,6 +182,7 @@ int main() {
         }
 
         // --- Input ---
+        profiler.beginPhase(FramePhase::Input);
         character.handleInput();
 
         // detect selected slot change and stop current action if selection changed
@@ -155,7 +204,11 @@ int main() {
         int mY = static_cast<int>(mouseWorldPos.y) / static_cast<int>(tileSize.y);
 
         // --- Actions (left-click behaviour depends on selected tool)
+        profiler.beginPhase(FramePhase::Actions);
         bool isLeftMousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Button::Left);
+        // No mining in a column that has not arrived yet
+        const bool targetArrived = mX >= 0 && mX < static_cast<int>(map.getWidth())
+            && columnArrived[static_cast<unsigned int>(mX) >> CHUNK_SHIFT];
         bool isRightMousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Button::Right);
 
         if (!inventoryPanel.getVisible()) {
@@ -167,11 +220,11 @@ int main() {
             }
             else if (heldId == TOOL_PICKAXE) {
                 // left mouse -> mining
-                actionManager.handleMining(character, map, mX, mY, breakableTiles, tileSize, deltaTime, isLeftMousePressed);
+                actionManager.handleMining(character, map, mX, mY, tileSize, deltaTime, isLeftMousePressed && targetArrived);
             }
             else {
                 // default behavior: left mining, right sword
-                actionManager.handleMining(character, map, mX, mY, breakableTiles, tileSize, deltaTime, isLeftMousePressed);
+                actionManager.handleMining(character, map, mX, mY, tileSize, deltaTime, isLeftMousePressed && targetArrived);
                 actionManager.handleSwordAttack(character, mX, mY, tileSize, deltaTime, isRightMousePressed);
             }
         }
@@ -180,15 +233,38 @@ int main() {
         }
 
         // --- Character Physics ---
+        profiler.beginPhase(FramePhase::Physics);
         character.update(deltaTime);
 
-        CollisionManager::resolveCharacterCollision(character, map, solidTiles);
-        character.setOnGround(CollisionManager::checkGroundCollision(character, map, solidTiles));
+        profiler.beginPhase(FramePhase::Collision);
+        CollisionManager::resolveCharacterCollision(character, map);
+        character.setOnGround(CollisionManager::checkGroundCollision(character, map));
 
-        if (CollisionManager::checkHitboxCollision(character.getHitbox(), map, solidTiles)) {
+        if (CollisionManager::checkHitboxCollision(character.getHitbox(), map)) {
             character.revertPosition();
         }
 
+        // --- World Simulation ---
+        profiler.beginPhase(FramePhase::World);
+        if (worldStreaming) {
+            // Columns finished after the hand-over replace the air they were left as, each in one
+            // write that also passes it on to the simulation thread. Checked before taking, so the
+            // last columns are never left behind.
+            worldStreaming = !generation.isFinished();
+            generation.takeColumns(generatedColumns);
+            for (const GeneratedColumn& column : generatedColumns) {
+                map.setRect(column.x, 0, column.width, map.getHeight(), column.tiles.data());
+                columnArrived[column.x >> CHUNK_SHIFT] = 1;
+            }
+        }
+        map.applySimulationChanges();
+        const WorldTickStats tickStats = simulation.getStats();
+        if (tickStats.ticksSkipped != reportedSkipped) {
+            std::cout << "World ticks falling behind: " << tickStats.ticksSkipped << " skipped, "
+                << tickStats.ticksLate << " late" << std::endl;
+            reportedSkipped = tickStats.ticksSkipped;
+        }
+
         // --- World Borders ---
         unsigned int map_width = map.getWidth();
         unsigned int map_height = map.getHeight();
@@ -205,6 +281,7 @@ int main() {
         }
 
         // --- Camera ---
+        profiler.beginPhase(FramePhase::Camera);
         sf::Vector2f cameraTarget = character.getPosition();
         sf::Vector2f cameraPos = view.getCenter();
         sf::Vector2f cameraMove = (cameraTarget - cameraPos) * 5.0f * deltaTime;
@@ -215,6 +292,7 @@ int main() {
         selectionBox.setPosition({ static_cast<float>(mX * tileSize.x), static_cast<float>(mY * tileSize.y) });
 
         // --- Rendering ---
+        profiler.beginPhase(FramePhase::Render);
         window.clear(sf::Color(120, 180, 240));
 
 		//World Draw 
@@ -228,8 +306,20 @@ int main() {
         playerInventory.draw(window, map.getTileSet());
         //Inventrory Panel draw
         inventoryPanel.draw(window);
+        profilerOverlay.draw(window, profiler);
         window.setView(view);
+
+        profiler.beginPhase(FramePhase::Present);
         window.display();
+        profiler.endFrame();
+
+        if (!startupReported) {
+            const float timeToInteractiveMs = startupClock.getElapsedTime().asSeconds() * 1000.f;
+            if (timeToFirstFrameMs < 0.f) timeToFirstFrameMs = timeToInteractiveMs; // no loading view was needed
+            std::cout << "Time to first frame: " << timeToFirstFrameMs << " ms, time to interactive: "
+                << timeToInteractiveMs << " ms" << std::endl;
+            startupReported = true;
+        }
     }
 
     return 0;
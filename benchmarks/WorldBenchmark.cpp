@@ -0,0 +1,340 @@
+// Headless benchmarks for the world hot paths: generation, liquids, collision and meshing.
+// Usage: world_bench [--quick] [--csv] [filter]
+//   --quick  only the smallest world sizes and shorter runs
+//   --csv    machine-readable output (name,width,height,ns_per_op,ops_per_sec,items_per_sec)
+//   filter   only run benchmarks whose name contains this string
+#include "DirtyRegionTracker.h"
+#include "LiquidSimulator.h"
+#include "ThreadPool.h"
+#include "TileCollision.h"
+#include "TileMesh.h"
+#include "TileStorage.h"
+#include "World.h"
+#include "WorldCache.h"
+#include "WorldNoise.h"
+#include "WorldPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct WorldSize {
+    unsigned int width;
+    unsigned int height;
+};
+
+struct Options {
+    bool quick = false;
+    bool csv = false;
+    std::string filter;
+    double minSeconds = 0.5;
+};
+
+Options g_options;
+
+void report(const std::string& name, const WorldSize& size, double nsPerOp, double itemsPerOp, const char* itemName) {
+    double opsPerSec = nsPerOp > 0.0 ? 1e9 / nsPerOp : 0.0;
+    double itemsPerSec = opsPerSec * itemsPerOp;
+    if (g_options.csv) {
+        std::printf("%s,%u,%u,%.1f,%.1f,%.1f\n", name.c_str(), size.width, size.height, nsPerOp, opsPerSec, itemsPerSec);
+    }
+    else {
+        std::printf("%-42s %5ux%-5u %14.1f ns/op %12.1f op/s %10.2f M%s/s\n",
+            name.c_str(), size.width, size.height, nsPerOp, opsPerSec, itemsPerSec / 1e6, itemName);
+    }
+    std::fflush(stdout);
+}
+
+bool selected(const std::string& name) {
+    return g_options.filter.empty() || name.find(g_options.filter) != std::string::npos;
+}
+
+// Runs setup() untimed and op() timed until minSeconds of measured time is collected.
+// Returns average nanoseconds per op().
+double measure(const std::function<void()>& setup, const std::function<void()>& op) {
+    using namespace std::chrono;
+    double measured = 0.0;
+    long long iterations = 0;
+    while (measured < g_options.minSeconds || iterations < 3) {
+        setup();
+        auto start = Clock::now();
+        op();
+        measured += duration<double>(Clock::now() - start).count();
+        ++iterations;
+    }
+    return measured * 1e9 / static_cast<double>(iterations);
+}
+
+// Same as measure() but for cheap ops: batches of n calls per timing sample
+double measureBatched(long long n, const std::function<void(long long)>& op) {
+    using namespace std::chrono;
+    double measured = 0.0;
+    long long iterations = 0;
+    while (measured < g_options.minSeconds) {
+        auto start = Clock::now();
+        op(n);
+        measured += duration<double>(Clock::now() - start).count();
+        iterations += n;
+    }
+    return measured * 1e9 / static_cast<double>(iterations);
+}
+
+const WorldSeed BENCH_SEED = 1234;
+
+TileStorage makeWorld(const WorldSize& size) {
+    TileStorage tiles(size.width, size.height);
+    generateWorld(tiles, BENCH_SEED);
+    return tiles;
+}
+
+double area(const WorldSize& size) {
+    return static_cast<double>(size.width) * size.height;
+}
+
+void benchGeneration(const WorldSize& size) {
+    if (selected("generateWorld")) {
+        TileStorage tiles;
+        double ns = measure(
+            [&] { tiles = TileStorage(size.width, size.height); },
+            [&] { generateWorld(tiles, BENCH_SEED); });
+        report("generateWorld", size, ns, area(size), "tiles");
+    }
+    if (selected("generateWorld/threaded")) {
+        static ThreadPool pool;
+        TileStorage tiles;
+        double ns = measure(
+            [&] { tiles = TileStorage(size.width, size.height); },
+            [&] { generateWorld(tiles, BENCH_SEED, &pool); });
+        report("generateWorld/threaded", size, ns, area(size), "tiles");
+    }
+
+    // Each generation stage on its own: the stages before it run untimed in the setup
+    TileStorage probe(size.width, size.height);
+    WorldPipeline stages(probe);
+    addWorldGenerationStages(stages, BENCH_SEED);
+    for (std::size_t stage = 0; stage < stages.getStageCount(); ++stage) {
+        const std::string name = std::string("WorldPipeline/") + stages.getStage(stage).name;
+        if (!selected(name)) continue;
+        TileStorage tiles;
+        std::unique_ptr<WorldPipeline> pipeline;
+        double ns = measure(
+            [&] {
+                tiles = TileStorage(size.width, size.height);
+                pipeline = std::make_unique<WorldPipeline>(tiles);
+                addWorldGenerationStages(*pipeline, BENCH_SEED);
+                if (stage > 0) pipeline->runThrough(stage - 1);
+            },
+            [&] { pipeline->runThrough(stage); });
+        report(name, size, ns, area(size), "tiles");
+    }
+
+    if (selected("loadCachedWorld")) {
+        // A repeat start: the generated world comes back from the on-disk cache
+        const WorldCacheKey key = makeWorldCacheKey(BENCH_SEED, size.width, size.height);
+        const std::string path = getWorldCachePath(std::filesystem::temp_directory_path().string(), key);
+        if (saveCachedWorld(path, key, makeWorld(size))) {
+            TileStorage tiles;
+            double ns = measure([] {}, [&] { loadCachedWorld(path, key, tiles); });
+            report("loadCachedWorld", size, ns, area(size), "tiles");
+            std::filesystem::remove(path);
+        }
+    }
+    if (selected("NoiseStrip::sampleRow")) {
+        // One cave-like field walked down the whole world, row after row
+        std::vector<float> row(size.width);
+        volatile float sink = 0.0f;
+        double ns = measure([] {}, [&] {
+            NoiseStrip strip({ BENCH_SEED, RandomPurpose::Cave, 0, 4, 2 }, 0, size.width);
+            for (unsigned int y = 0; y < size.height; ++y) {
+                strip.sampleRow(static_cast<int>(y), row.data());
+            }
+            sink = sink + row[0];
+        });
+        report("NoiseStrip::sampleRow", size, ns, area(size), "samples");
+    }
+}
+
+void benchLiquids(const WorldSize& size) {
+    // Fresh liquids are still moving, so each sample starts from the same unsettled world
+    TileStorage world = makeWorld(size);
+    static ThreadPool pool;
+    struct Pass { const char* name; std::function<void(TileStorage&)> fn; };
+    const Pass passes[] = {
+        { "simulateWaterFlow", [](TileStorage& t) { simulateWaterFlow(t, BENCH_SEED, 0); } },
+        { "simulateLavaFlow", [](TileStorage& t) { simulateLavaFlow(t, BENCH_SEED, 0); } },
+        { "simulateWaterFlow/threaded", [&](TileStorage& t) { simulateWaterFlow(t, BENCH_SEED, 0, &pool); } },
+        { "simulateLavaFlow/threaded", [&](TileStorage& t) { simulateLavaFlow(t, BENCH_SEED, 0, &pool); } },
+        { "checkLiquidInteractions", [](TileStorage& t) { checkLiquidInteractions(t); } },
+        { "updateWorld", [](TileStorage& t) { updateWorld(t, BENCH_SEED, 0); } },
+    };
+    for (const Pass& pass : passes) {
+        if (!selected(pass.name)) continue;
+        TileStorage tiles;
+        double ns = measure(
+            [&] { tiles = world.clone(); },
+            [&] { pass.fn(tiles); });
+        report(pass.name, size, ns, area(size), "tiles");
+    }
+
+    // Same rules as updateWorld, but only liquid that can still move is visited. The first step
+    // after reset() visits every liquid cell, so it runs untimed in the setup.
+    const std::string name = "LiquidSimulator::step";
+    if (selected(name)) {
+        TileStorage tiles;
+        LiquidSimulator sim(BENCH_SEED);
+        double ns = measure(
+            [&] { tiles = world.clone(); sim.reset(tiles); sim.step(tiles); },
+            [&] { sim.step(tiles); });
+        report(name, size, ns, area(size), "tiles");
+    }
+}
+
+void benchCollision(const WorldSize& size) {
+    const std::string name = "hitboxIntersectsSolidTile";
+    if (!selected(name)) return;
+
+    TileStorage tiles = makeWorld(size);
+    const float tileSize = 46.f;
+
+    // Player-sized hitboxes scattered over the whole world, precomputed so only the query is timed
+    std::vector<TileRect> boxes(4096);
+    std::srand(42);
+    for (TileRect& box : boxes) {
+        box.left = static_cast<float>(std::rand() % (size.width * 46));
+        box.top = static_cast<float>(std::rand() % (size.height * 46));
+        box.width = 67.f;
+        box.height = 86.f;
+    }
+
+    volatile int hits = 0;
+    double ns = measureBatched(static_cast<long long>(boxes.size()), [&](long long n) {
+        int local = 0;
+        for (long long i = 0; i < n; ++i) {
+            local += hitboxIntersectsSolidTile(tiles, tileSize, tileSize, boxes[static_cast<std::size_t>(i)]);
+        }
+        hits = hits + local;
+    });
+    report(name, size, ns, 1.0, "queries");
+}
+
+void benchMeshing(const WorldSize& size) {
+    TileStorage tiles = makeWorld(size);
+    const sf::Vector2u tileSize(46u, 46u);
+    const unsigned int tilesetColumns = 16;
+
+    if (selected("TileMesh::rebuild")) {
+        TileMesh mesh;
+        double ns = measure([] {}, [&] { mesh.rebuild(tiles, tileSize, tilesetColumns); });
+        report("TileMesh::rebuild", size, ns, area(size), "tiles");
+    }
+
+    TileMesh mesh;
+    mesh.rebuild(tiles, tileSize, tilesetColumns);
+
+    // TileMap::updateTileVertices equivalent: re-mesh a single tile in place
+    if (selected("TileMesh::updateTile")) {
+        unsigned int x = 0, y = 0;
+        double ns = measureBatched(1 << 16, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                mesh.updateTile(tiles, x, y);
+                if (++x == size.width) { x = 0; if (++y == size.height) y = 0; }
+            }
+        });
+        report("TileMesh::updateTile", size, ns, 1.0, "tiles");
+    }
+
+    // TileMap::setTile path: storage write, mesh update and dirty-region mark
+    if (selected("TileMap::setTile")) {
+        DirtyRegionTracker dirty;
+        dirty.resize(tiles.getChunksX(), tiles.getChunksY());
+        std::vector<DirtyRegion> regions;
+        unsigned int x = 0, y = size.height / 2;
+        Tile value = TILE_STONE;
+        double ns = measureBatched(1 << 16, [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                tiles.setTile(x, y, value);
+                mesh.onTileChanged(tiles, x, y);
+                dirty.markTile(x, y);
+                if (++x == size.width) {
+                    x = 0;
+                    if (++y == size.height) y = size.height / 2;
+                    value = (value == TILE_STONE) ? TILE_DIRT : TILE_STONE;
+                }
+            }
+        });
+        dirty.drain(regions);
+        report("TileMap::setTile", size, ns, 1.0, "tiles");
+    }
+
+    // A 48x48 region rewritten tile by tile vs. as one batch (TileMap::fillRect path)
+    const unsigned int rect = std::min(48u, size.height / 2);
+    const unsigned int rectX = size.width / 2 - rect / 2;
+    const unsigned int rectY = size.height / 2;
+    Tile fill = TILE_STONE;
+    if (selected("fillRect/per-tile")) {
+        double ns = measure([] {}, [&] {
+            fill = (fill == TILE_STONE) ? TILE_DIRT : TILE_STONE;
+            for (unsigned int y = rectY; y < rectY + rect; ++y) {
+                for (unsigned int x = rectX; x < rectX + rect; ++x) {
+                    tiles.setTile(x, y, fill);
+                    mesh.onTileChanged(tiles, x, y);
+                }
+            }
+        });
+        report("fillRect/per-tile", size, ns, rect * rect, "tiles");
+    }
+    if (selected("fillRect/batched")) {
+        double ns = measure([] {}, [&] {
+            fill = (fill == TILE_STONE) ? TILE_DIRT : TILE_STONE;
+            for (unsigned int y = rectY; y < rectY + rect; ++y) {
+                for (unsigned int x = rectX; x < rectX + rect; ++x) {
+                    tiles.setTile(x, y, fill);
+                    mesh.markTileChanged(x, y);
+                }
+            }
+            mesh.updateMarkedTiles(tiles);
+        });
+        report("fillRect/batched", size, ns, rect * rect, "tiles");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) g_options.quick = true;
+        else if (std::strcmp(argv[i], "--csv") == 0) g_options.csv = true;
+        else g_options.filter = argv[i];
+    }
+
+    std::vector<WorldSize> sizes = { { 100, 60 }, { 512, 256 }, { 2048, 512 } };
+    if (g_options.quick) {
+        sizes.resize(2);
+        g_options.minSeconds = 0.1;
+    }
+
+    if (g_options.csv) {
+        std::printf("name,width,height,ns_per_op,ops_per_sec,items_per_sec\n");
+    }
+    else {
+        std::printf("noise: %s\n", getNoisePath());
+    }
+
+    for (const WorldSize& size : sizes) {
+        benchGeneration(size);
+        benchLiquids(size);
+        benchCollision(size);
+        benchMeshing(size);
+    }
+    return 0;
+}
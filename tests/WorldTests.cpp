@@ -0,0 +1,659 @@
+// Headless checks for the world core.
+// Usage: world_tests [name]
+//   name  only run the tests whose name contains this string (ctest runs them one at a time)
+// Exits with 1 if any test fails.
+#include "LiquidSimulator.h"
+#include "ThreadPool.h"
+#include "TileStorage.h"
+#include "TileWorld.h"
+#include "World.h"
+#include "WorldCache.h"
+#include "WorldPipeline.h"
+#include "WorldTickScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct WorldSize {
+    unsigned int width;
+    unsigned int height;
+};
+
+// Odd sizes on purpose: the last chunk column and row are only partly inside the world
+const WorldSize SIZES[] = { { 100, 60 }, { 160, 96 }, { 300, 150 } };
+const WorldSeed SEEDS[] = { 1, 42, 1234 };
+
+int g_failures = 0;
+
+void check(bool condition, const char* what, const WorldSize& size, WorldSeed seed) {
+    if (condition) return;
+    std::printf("  failed: %s (%ux%u, seed %llu)\n", what, size.width, size.height,
+        static_cast<unsigned long long>(seed));
+    ++g_failures;
+}
+
+// FNV-1a over every tile and every column's surface row
+std::uint64_t hashWorld(const TileStorage& tiles) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint32_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    for (unsigned int y = 0; y < tiles.getHeight(); ++y) {
+        for (unsigned int x = 0; x < tiles.getWidth(); ++x) {
+            mix(static_cast<std::uint16_t>(tiles.getTile(x, y)));
+        }
+    }
+    for (unsigned int x = 0; x < tiles.getWidth(); ++x) {
+        mix(static_cast<std::uint32_t>(tiles.getSurfaceY(x)));
+    }
+    return hash;
+}
+
+// The surface cache must agree with a scan for the topmost grass
+bool surfaceMatchesTiles(const TileStorage& tiles) {
+    for (unsigned int x = 0; x < tiles.getWidth(); ++x) {
+        int topGrass = -1;
+        for (unsigned int y = 0; y < tiles.getHeight() && topGrass < 0; ++y) {
+            if (tiles.getTile(x, y) == TILE_GRASS) topGrass = static_cast<int>(y);
+        }
+        if (topGrass != tiles.getSurfaceY(x)) return false;
+    }
+    return true;
+}
+
+// Generation with a pool, one chunk column per task, makes the same world as without one
+void testParallelGeneration() {
+    ThreadPool pool(4);
+    for (const WorldSize& size : SIZES) {
+        for (WorldSeed seed : SEEDS) {
+            TileStorage serial(size.width, size.height);
+            generateWorld(serial, seed);
+            check(surfaceMatchesTiles(serial), "surface rows match the grass", size, seed);
+
+            TileStorage pooled(size.width, size.height);
+            generateWorld(pooled, seed, &pool);
+            check(hashWorld(pooled) == hashWorld(serial), "pooled generation matches serial", size, seed);
+        }
+    }
+}
+
+// Chunks generated on demand, in any order and any number of stages at a time, come out as if
+// the whole world had gone through the pipeline stage by stage
+void testPipelineOrders() {
+    ThreadPool pool(4);
+    for (const WorldSize& size : SIZES) {
+        for (WorldSeed seed : SEEDS) {
+            TileStorage serial(size.width, size.height);
+            generateWorld(serial, seed);
+            const std::uint64_t expected = hashWorld(serial);
+
+            std::mt19937 random(static_cast<std::uint32_t>(seed));
+            for (int order = 0; order < 3; ++order) {
+                TileStorage lazy(size.width, size.height);
+                WorldPipeline pipeline(lazy);
+                addWorldGenerationStages(pipeline, seed);
+
+                std::vector<std::pair<unsigned int, unsigned int>> chunks;
+                for (unsigned int cy = 0; cy < lazy.getChunksY(); ++cy) {
+                    for (unsigned int cx = 0; cx < lazy.getChunksX(); ++cx) chunks.push_back({ cx, cy });
+                }
+                std::shuffle(chunks.begin(), chunks.end(), random);
+
+                if (order == 0) {
+                    // Every chunk on demand, all the way
+                    for (const auto& chunk : chunks) pipeline.ensureChunk(chunk.first, chunk.second);
+                }
+                else {
+                    // Some chunks part of the way, then the rest stage by stage
+                    for (const auto& chunk : chunks) {
+                        pipeline.ensureChunk(chunk.first, chunk.second, random() % pipeline.getStageCount());
+                    }
+                    pipeline.runAll(order == 2 ? &pool : nullptr);
+                }
+                check(hashWorld(lazy) == expected, "lazy generation matches serial", size, seed);
+            }
+        }
+    }
+}
+
+// Generation leaves every pool resting on something, and running out of ticks is reported
+void testSettledLiquids() {
+    for (const WorldSize& size : SIZES) {
+        for (WorldSeed seed : SEEDS) {
+            TileStorage tiles(size.width, size.height);
+            const LiquidSettleReport report = generateWorld(tiles, seed);
+            check(report.settled, "liquids settled", size, seed);
+            check(countLiquidOverAir(tiles) == 0, "no liquid over air", size, seed);
+            check(report.unsupportedCells == 0, "report counts no liquid over air", size, seed);
+        }
+    }
+
+    // A tall column of water in the sky cannot land in two ticks
+    const WorldSize size = SIZES[0];
+    TileStorage sky(size.width, size.height);
+    for (unsigned int y = 0; y < 10; ++y) sky.setTile(50, y, TILE_WATER);
+    const LiquidSettleReport capped = settleLiquids(sky, SEEDS[0], 2);
+    check(!capped.settled && capped.ticks == 2, "tick limit reported as not settled", size, SEEDS[0]);
+    check(capped.unsupportedCells > 0, "tick limit leaves liquid over air", size, SEEDS[0]);
+    check(settleLiquids(sky, SEEDS[0]).settled && countLiquidOverAir(sky) == 0, "water lands on the bottom", size, SEEDS[0]);
+}
+
+// A pool across the seam at x = 64, as the liquids stage leaves it: water stands against the wall
+// at the edge of the first column and the second column's half of the basin is dry
+void testLiquidSeams() {
+    const WorldSize size = SIZES[1];
+    const WorldSeed seed = SEEDS[0];
+    auto makeBasin = [&size] {
+        TileStorage tiles(size.width, size.height);
+        for (unsigned int x = 30; x <= 100; ++x) tiles.setTile(x, 70, TILE_STONE);
+        for (unsigned int y = 50; y < 70; ++y) {
+            tiles.setTile(30, y, TILE_STONE);
+            tiles.setTile(100, y, TILE_STONE);
+        }
+        for (unsigned int y = 60; y < 70; ++y) {
+            for (unsigned int x = 31; x < 64; ++x) tiles.setTile(x, y, TILE_WATER);
+        }
+        return tiles;
+    };
+    auto countWater = [](const TileStorage& tiles, unsigned int x0, unsigned int x1, unsigned int y0) {
+        std::size_t count = 0;
+        for (unsigned int y = y0; y < tiles.getHeight(); ++y) {
+            for (unsigned int x = x0; x < x1; ++x) count += tiles.getTile(x, y) == TILE_WATER;
+        }
+        return count;
+    };
+
+    // Walled in to the first column the pool does not move
+    TileStorage walled = makeBasin();
+    const LiquidSettleReport alone = settleLiquidSeams(walled, seed, 0, 0);
+    check(alone.settled && countWater(walled, 64, 100, 0) == 0, "a single column stays walled in", size, seed);
+
+    TileStorage tiles = makeBasin();
+    const LiquidSettleReport report = settleLiquidSeams(tiles, seed, 0, tiles.getChunksX() - 1);
+    check(report.settled && report.ticks > 0, "seam pass settles", size, seed);
+    check(countLiquidOverAir(tiles) == 0 && report.unsupportedCells == 0, "no liquid over air after the seam pass", size, seed);
+    check(countWater(tiles, 64, 100, 0) > 0, "water crosses the seam", size, seed);
+    // Level: the ten rows standing at the seam have spread out, down to the floor's few rows
+    check(countWater(tiles, 0, size.width, 0) == countWater(tiles, 0, size.width, 65), "pool levelled across the seam", size, seed);
+}
+
+// updateWorld's fused sweep gives the tiles of the water, lava and interaction passes run one
+// after the other
+void testFusedUpdate() {
+    auto matchesSeparatePasses = [](const TileStorage& start, WorldSeed seed, std::uint32_t ticks) {
+        TileStorage fused = start.clone();
+        TileStorage separate = start.clone();
+        for (std::uint32_t tick = 0; tick < ticks; ++tick) {
+            updateWorld(fused, seed, tick);
+            simulateWaterFlow(separate, seed, tick);
+            simulateLavaFlow(separate, seed, tick);
+            checkLiquidInteractions(separate);
+            if (hashWorld(fused) != hashWorld(separate)) return false;
+        }
+        return true;
+    };
+
+    for (const WorldSize& size : SIZES) {
+        for (WorldSeed seed : SEEDS) {
+            TileStorage tiles(size.width, size.height);
+            generateWorld(tiles, seed);
+            std::mt19937 random(static_cast<std::uint32_t>(seed));
+            for (int i = 0; i < 12; ++i) {
+                const int x = static_cast<int>(random() % size.width);
+                const int y = static_cast<int>(random() % (size.height - 20));
+                if (i % 2 == 0) {
+                    generateWaterPool(tiles, x, y, 3 + static_cast<int>(random() % 4));
+                }
+                else {
+                    generateLavaPool(tiles, x, y, 3 + static_cast<int>(random() % 4));
+                }
+            }
+            check(matchesSeparatePasses(tiles, seed, 64), "fused update matches separate passes", size, seed);
+        }
+    }
+
+    // Lava resting on water, and lava over air over water, with the layers meeting at the chunk row
+    // edge y = 63 | 64 and at the bottom of the world
+    const WorldSize size = SIZES[1];
+    for (WorldSeed seed : SEEDS) {
+        TileStorage tiles(size.width, size.height);
+        for (unsigned int x = 10; x < 150; ++x) {
+            tiles.setTile(x, 65, TILE_STONE);
+            tiles.setTile(x, 64, TILE_WATER);
+            tiles.setTile(x, 63, x < 80 ? TILE_LAVA : TILE_AIR);
+            tiles.setTile(x, 62, x < 80 ? TILE_LAVA : TILE_WATER);
+            if (x >= 80) tiles.setTile(x, 61, TILE_LAVA);
+            tiles.setTile(x, size.height - 1, TILE_WATER);
+            if (x % 3 == 0) tiles.setTile(x, size.height - 2, TILE_LAVA);
+        }
+        check(matchesSeparatePasses(tiles, seed, 32), "lava over water at chunk row edges", size, seed);
+    }
+}
+
+// The flow passes split into strips of chunk rows on a pool give the serial result, tick by tick
+void testLiquidStrips() {
+    const WorldSize size = { 200, 200 }; // four strips, the last one short
+    ThreadPool pool(4);
+    for (WorldSeed seed : SEEDS) {
+        TileStorage serial(size.width, size.height);
+        generateWorld(serial, seed);
+
+        // Drop blobs of both liquids through the sky and into the caves, across strip edges
+        std::mt19937 random(static_cast<std::uint32_t>(seed));
+        for (int i = 0; i < 24; ++i) {
+            const int x = static_cast<int>(random() % size.width);
+            const int y = static_cast<int>(random() % (size.height - 20));
+            if (i % 2 == 0) {
+                generateWaterPool(serial, x, y, 3 + static_cast<int>(random() % 4));
+            }
+            else {
+                generateLavaPool(serial, x, y, 3 + static_cast<int>(random() % 4));
+            }
+        }
+        TileStorage pooled = serial.clone();
+
+        bool same = true;
+        for (std::uint32_t tick = 0; tick < 64 && same; ++tick) {
+            simulateWaterFlow(serial, seed, tick);
+            simulateWaterFlow(pooled, seed, tick, &pool);
+            simulateLavaFlow(serial, seed, tick);
+            simulateLavaFlow(pooled, seed, tick, &pool);
+            checkLiquidInteractions(serial);
+            checkLiquidInteractions(pooled);
+            same = hashWorld(serial) == hashWorld(pooled);
+        }
+        check(same, "strip-parallel liquid passes match serial", size, seed);
+    }
+}
+
+// A saved world loads back tile for tile; a file for another key, or a damaged one, is refused
+void testCacheRoundTrip() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "world_tests_cache";
+    std::filesystem::remove_all(directory);
+
+    const WorldSize size = SIZES[2];
+    const WorldSeed seed = SEEDS[1];
+    TileStorage world(size.width, size.height);
+    generateWorld(world, seed);
+
+    const WorldCacheKey key = makeWorldCacheKey(seed, size.width, size.height);
+    const std::string path = getWorldCachePath(directory.string(), key);
+    check(saveCachedWorld(path, key, world), "world saved", size, seed);
+
+    TileStorage loaded;
+    check(loadCachedWorld(path, key, loaded), "world loaded", size, seed);
+    check(loaded.getWidth() == size.width && loaded.getHeight() == size.height, "loaded size", size, seed);
+    check(hashWorld(loaded) == hashWorld(world), "loaded tiles and surfaces match", size, seed);
+
+    WorldCacheKey otherSeed = key;
+    otherSeed.seed = seed + 1;
+    TileStorage untouched;
+    check(!loadCachedWorld(path, otherSeed, untouched) && untouched.getWidth() == 0,
+        "file for another seed refused", size, seed);
+
+    // Only the world file itself is left behind
+    std::size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        (void)entry;
+        ++files;
+    }
+    check(files == 1, "no temporary file left", size, seed);
+
+    // The file ends with the chunk indices, then every chunk's tiles
+    std::size_t chunks = 0;
+    for (unsigned int cy = 0; cy < world.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < world.getChunksX(); ++cx) chunks += world.getChunk(cx, cy) != nullptr;
+    }
+    const std::uintmax_t tilesOffset = std::filesystem::file_size(path) - chunks * CHUNK_SIZE * CHUNK_SIZE * sizeof(Tile);
+    const std::uintmax_t indicesOffset = tilesOffset - chunks * sizeof(std::uint32_t);
+    auto loadDamaged = [&](std::uintmax_t offset, const void* bytes, std::size_t count) {
+        const std::filesystem::path damaged = directory / "damaged.bin";
+        std::filesystem::copy_file(path, damaged, std::filesystem::copy_options::overwrite_existing);
+        {
+            std::fstream file(damaged, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(offset));
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+        }
+        TileStorage target;
+        return loadCachedWorld(damaged.string(), key, target) || target.getWidth() != 0;
+    };
+
+    const Tile unknown = TILE_COUNT;
+    check(!loadDamaged(tilesOffset, &unknown, sizeof(unknown)), "file with an unknown tile refused", size, seed);
+    std::uint32_t firstIndex = 0;
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(indicesOffset));
+        file.read(reinterpret_cast<char*>(&firstIndex), sizeof(firstIndex));
+    }
+    check(chunks > 1 && !loadDamaged(indicesOffset + sizeof(std::uint32_t), &firstIndex, sizeof(firstIndex)),
+        "file naming a chunk twice refused", size, seed);
+
+    // A truncated file is refused too
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    check(!loadCachedWorld(path, key, untouched), "truncated file refused", size, seed);
+
+    std::filesystem::remove_all(directory);
+}
+
+// Steps the liquid simulator and updateWorld side by side from the same tiles, comparing every tick
+bool simulatorMatchesUpdateWorld(const TileStorage& start, WorldSeed seed, std::uint32_t ticks) {
+    TileStorage simulated = start.clone();
+    TileStorage updated = start.clone();
+    LiquidSimulator liquids(seed);
+    liquids.reset(simulated);
+    for (std::uint32_t tick = 0; tick < ticks; ++tick) {
+        updateWorld(updated, seed, liquids.getTick());
+        liquids.step(simulated);
+        if (hashWorld(simulated) != hashWorld(updated)) return false;
+    }
+    return true;
+}
+
+// The active-set simulator gives exactly updateWorld's tiles, tick by tick
+void testLiquidSimulator() {
+    for (const WorldSize& size : SIZES) {
+        for (WorldSeed seed : SEEDS) {
+            // Generated worlds have settled, so drop fresh liquid into them as well
+            TileStorage tiles(size.width, size.height);
+            generateWorld(tiles, seed);
+            check(simulatorMatchesUpdateWorld(tiles, seed, 64), "simulator matches updateWorld on a generated world", size, seed);
+
+            std::mt19937 random(static_cast<std::uint32_t>(seed));
+            for (int i = 0; i < 12; ++i) {
+                const int x = static_cast<int>(random() % size.width);
+                const int y = static_cast<int>(random() % (size.height - 20));
+                if (i % 2 == 0) {
+                    generateWaterPool(tiles, x, y, 3 + static_cast<int>(random() % 4));
+                }
+                else {
+                    generateLavaPool(tiles, x, y, 3 + static_cast<int>(random() % 4));
+                }
+            }
+            check(simulatorMatchesUpdateWorld(tiles, seed, 128), "simulator matches updateWorld with new liquid", size, seed);
+        }
+    }
+
+    // Hand-built setups around the chunk corner at (64, 64)
+    const WorldSize size = SIZES[1];
+    auto fill = [](TileStorage& tiles, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, Tile tile) {
+        for (unsigned int y = y0; y <= y1; ++y) {
+            for (unsigned int x = x0; x <= x1; ++x) tiles.setTile(x, y, tile);
+        }
+    };
+    for (WorldSeed seed : SEEDS) {
+        // Water poured onto a lava lake
+        TileStorage lake(size.width, size.height);
+        fill(lake, 40, 73, 90, 73, TILE_STONE);
+        fill(lake, 40, 69, 90, 72, TILE_LAVA);
+        fill(lake, 55, 50, 72, 55, TILE_WATER);
+        check(simulatorMatchesUpdateWorld(lake, seed, 96), "water onto lava", size, seed);
+
+        // Lava dropped into a water basin across both chunk edges
+        TileStorage basin(size.width, size.height);
+        fill(basin, 54, 70, 76, 70, TILE_STONE);
+        fill(basin, 54, 58, 54, 69, TILE_STONE);
+        fill(basin, 76, 58, 76, 69, TILE_STONE);
+        fill(basin, 55, 62, 75, 69, TILE_WATER);
+        fill(basin, 60, 40, 68, 45, TILE_LAVA);
+        check(simulatorMatchesUpdateWorld(basin, seed, 96), "lava into water", size, seed);
+
+        // Water and lava either side of an obsidian wall with a gap in it
+        TileStorage wall(size.width, size.height);
+        fill(wall, 40, 80, 90, 80, TILE_STONE);
+        fill(wall, 64, 40, 64, 79, TILE_OBSIDIAN);
+        wall.setTile(64, 70, TILE_AIR);
+        fill(wall, 50, 60, 63, 79, TILE_WATER);
+        fill(wall, 65, 55, 78, 79, TILE_LAVA);
+        check(simulatorMatchesUpdateWorld(wall, seed, 96), "water and lava through an obsidian wall", size, seed);
+    }
+}
+
+// The tick scheduler fed made-up frame times. Ticks at 16 per second, so every period and frame
+// time below is exact in a float.
+void testTickScheduler() {
+    const WorldSize size = { 0, 0 };
+    const WorldSeed seed = 0;
+    std::uint32_t ticks = 0;
+    auto countTick = [&ticks] { ++ticks; };
+
+    // Short frames add up to one tick on the fourth
+    WorldTickScheduler shortFrames(16.f, 1000.f, 10);
+    std::uint32_t ran[4];
+    for (std::uint32_t& frame : ran) frame = shortFrames.update(1.f / 64.f, countTick);
+    check(ran[0] == 0 && ran[1] == 0 && ran[2] == 0 && ran[3] == 1, "a tick every fourth short frame", size, seed);
+    check(shortFrames.getStats().ticksRun == 1 && shortFrames.getStats().ticksLate == 0
+        && shortFrames.getStats().ticksSkipped == 0 && shortFrames.getStats().backlog == 0, "short frame stats", size, seed);
+
+    // A one second stall owes 16 ticks: 10 run at once, the 6 oldest are dropped
+    WorldTickScheduler stall(16.f, 1000.f, 10);
+    check(stall.update(1.f, countTick) == 10, "stall runs maxBacklog ticks", size, seed);
+    check(stall.getStats().ticksSkipped == 6 && stall.getStats().ticksLate == 0 && stall.getStats().backlog == 0,
+        "stall skips the rest", size, seed);
+
+    // Every tick takes longer than the budget, so each frame runs just the one it must. Frames of
+    // three ticks each leave 2, 4, 6, 8 carried over, then 11 due is one past maxBacklog.
+    WorldTickScheduler overBudget(16.f, 4.f, 10);
+    auto slowTick = [&ticks] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ++ticks;
+    };
+    ticks = 0;
+    for (int frame = 0; frame < 5; ++frame) overBudget.update(3.f / 16.f, slowTick);
+    const WorldTickStats& stats = overBudget.getStats();
+    check(ticks == 5 && stats.ticksRun == 5, "one tick per frame over budget", size, seed);
+    check(stats.ticksLate == 4 && stats.ticksSkipped == 1 && stats.backlog == 9, "over budget late and skipped", size, seed);
+    check(stats.lastUpdateMs >= 5.f, "frame time measured", size, seed);
+}
+
+// Two copies of a world, one edited in batches and one a tile at a time with setTile, must end up
+// with the same tiles, bitboards, surface rows and visible chunk meshes
+bool sameTileWorlds(const TileWorld& a, const TileWorld& b) {
+    const TileStorage& left = a.getTiles();
+    const TileStorage& right = b.getTiles();
+    if (hashWorld(left) != hashWorld(right)) return false;
+    for (unsigned int cy = 0; cy < left.getChunksY(); ++cy) {
+        for (unsigned int cx = 0; cx < left.getChunksX(); ++cx) {
+            const Chunk* l = left.getChunk(cx, cy);
+            const Chunk* r = right.getChunk(cx, cy);
+            if (!l != !r) return false;
+            if (l && (l->air != r->air || l->water != r->water || l->lava != r->lava)) return false;
+
+            const std::vector<sf::Vertex>& lv = a.getMesh().getChunkVertices(cx, cy);
+            const std::vector<sf::Vertex>& rv = b.getMesh().getChunkVertices(cx, cy);
+            if (lv.size() != rv.size()) return false;
+            for (std::size_t i = 0; i < lv.size(); ++i) {
+                // Air quads are see-through and keep whatever position they had, so only their colour counts
+                if (lv[i].color != rv[i].color) return false;
+                if (lv[i].color.a != 0 && (lv[i].position != rv[i].position || lv[i].texCoords != rv[i].texCoords)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// setTiles, fillRect and setSpan give what setTile does cell by cell, grass removed and added
+// included, across chunk edges and clipped at the map edge
+void testBatchedEdits() {
+    const WorldSize size = SIZES[2];
+    const sf::Vector2u tileSize(16, 16);
+    const Tile liquidsAndBlocks[] = { TILE_WATER, TILE_LAVA, TILE_STONE, TILE_GRASS, TILE_AIR, TILE_DIRT };
+    for (WorldSeed seed : SEEDS) {
+        TileStorage tiles(size.width, size.height);
+        generateWorld(tiles, seed);
+        TileWorld batched, single;
+        batched.load(tiles.clone(), tileSize, 16);
+        single.load(std::move(tiles), tileSize, 16);
+        auto setEach = [&single](const std::vector<TileEdit>& edits) {
+            for (const TileEdit& edit : edits) single.setTile(edit.x, edit.y, edit.tile);
+        };
+
+        // Dig out the surface across the chunk edge at x = 64, taking the grass with it
+        const unsigned int top = static_cast<unsigned int>(std::max(batched.getSurfaceY(60), 3) - 3);
+        batched.fillRect(56, top, 16, 8, TILE_AIR);
+        std::vector<TileEdit> edits;
+        for (unsigned int y = top; y < top + 8; ++y) {
+            for (unsigned int x = 56; x < 72; ++x) edits.push_back({ x, y, TILE_AIR });
+        }
+        setEach(edits);
+        check(sameTileWorlds(batched, single), "fillRect matches setTile", size, seed);
+
+        // A rect hanging over the bottom right corner is clipped
+        batched.fillRect(size.width - 5, size.height - 3, 20, 20, TILE_WATER);
+        edits.clear();
+        for (unsigned int y = size.height - 3; y < size.height; ++y) {
+            for (unsigned int x = size.width - 5; x < size.width; ++x) edits.push_back({ x, y, TILE_WATER });
+        }
+        setEach(edits);
+        check(sameTileWorlds(batched, single), "clipped fillRect matches setTile", size, seed);
+
+        // Scattered edits, some cells twice and some off the map
+        std::mt19937 random(static_cast<std::uint32_t>(seed));
+        edits.clear();
+        for (int i = 0; i < 400; ++i) {
+            const unsigned int x = random() % (size.width + 8);
+            const unsigned int y = random() % (size.height + 8);
+            edits.push_back({ x, y, liquidsAndBlocks[random() % 6] });
+            if (i % 10 == 0) edits.push_back({ x, y, liquidsAndBlocks[random() % 6] });
+        }
+        batched.setTiles(edits);
+        setEach(edits);
+        check(sameTileWorlds(batched, single), "setTiles matches setTile", size, seed);
+
+        // Rows across chunk edges: new grass above the old surface, then the grass row cleared again
+        std::vector<Tile> row(150);
+        for (std::size_t i = 0; i < row.size(); ++i) row[i] = i % 7 == 0 ? TILE_GRASS : liquidsAndBlocks[i % 6];
+        for (unsigned int y : { 10u, 63u, 64u }) {
+            batched.setSpan(size.width - 140, y, row.data(), static_cast<unsigned int>(row.size()));
+            edits.clear();
+            for (unsigned int i = 0; i < 140; ++i) edits.push_back({ size.width - 140 + i, y, row[i] });
+            setEach(edits);
+        }
+        check(sameTileWorlds(batched, single), "setSpan matches setTile", size, seed);
+        const std::vector<Tile> air(size.width, TILE_AIR);
+        batched.setSpan(0, 10, air.data(), size.width);
+        for (unsigned int x = 0; x < size.width; ++x) single.setTile(x, 10, TILE_AIR);
+        check(sameTileWorlds(batched, single), "setSpan clearing grass matches setTile", size, seed);
+        check(surfaceMatchesTiles(batched.getTiles()), "surface rows follow batched edits", size, seed);
+    }
+}
+
+// Drains world's dirty regions and compares them, in order, with expected
+bool drainsTo(TileWorld& world, const std::vector<DirtyRegion>& expected) {
+    std::vector<DirtyRegion> regions;
+    world.drainDirtyRegions(regions);
+    if (regions.size() != expected.size() || world.hasDirtyRegions()) return false;
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        const DirtyRegion& a = regions[i];
+        const DirtyRegion& b = expected[i];
+        if (a.chunkX != b.chunkX || a.chunkY != b.chunkY || a.left != b.left || a.top != b.top
+            || a.width != b.width || a.height != b.height) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every way of editing a TileWorld leaves one bounding box per changed chunk, and draining clears them
+void testDirtyRegions() {
+    const WorldSize size = SIZES[1];
+    const WorldSeed seed = SEEDS[0];
+    TileStorage tiles(size.width, size.height);
+    for (unsigned int x = 0; x < size.width; ++x) tiles.setTile(x, size.height - 1, TILE_BEDROCK);
+    TileWorld world;
+    world.load(std::move(tiles), sf::Vector2u(16, 16), 16);
+    check(!world.hasDirtyRegions(), "nothing dirty after load", size, seed);
+
+    world.setTile(70, 10, TILE_STONE);
+    world.setTile(75, 12, TILE_STONE);
+    check(drainsTo(world, { { 1, 0, 70, 10, 6, 3 } }), "setTile grows one box", size, seed);
+    check(drainsTo(world, {}), "draining clears the boxes", size, seed);
+
+    world.setTiles({ { 10, 10, TILE_DIRT }, { 130, 70, TILE_DIRT }, { 12, 5, TILE_DIRT }, { 500, 5, TILE_DIRT } });
+    check(drainsTo(world, { { 0, 0, 10, 5, 3, 6 }, { 2, 1, 130, 70, 1, 1 } }), "setTiles boxes per chunk", size, seed);
+    world.setTiles({ { 10, 10, TILE_DIRT } });
+    check(drainsTo(world, {}), "setTiles that changes nothing marks nothing", size, seed);
+
+    world.fillRect(60, 60, 8, 8, TILE_STONE);
+    check(drainsTo(world, { { 0, 0, 60, 60, 4, 4 }, { 1, 0, 64, 60, 4, 4 }, { 0, 1, 60, 64, 4, 4 }, { 1, 1, 64, 64, 4, 4 } }),
+        "fillRect marks its rectangle in each chunk", size, seed);
+    world.fillRect(60, 60, 8, 8, TILE_STONE);
+    check(drainsTo(world, {}), "fillRect that changes nothing marks nothing", size, seed);
+    world.fillRect(size.width - 2, size.height - 3, 10, 10, TILE_GRAVEL);
+    check(drainsTo(world, { { 2, 1, size.width - 2, size.height - 3, 2, 3 } }), "fillRect clipped at the map edge", size, seed);
+
+    const Tile span[] = { TILE_SAND, TILE_SAND, TILE_SAND, TILE_SAND };
+    world.setSpan(62, 5, span, 4);
+    check(drainsTo(world, { { 0, 0, 62, 5, 2, 1 }, { 1, 0, 64, 5, 2, 1 } }), "setSpan across a chunk edge", size, seed);
+
+    // A streamed column's bulk write: one rectangle, row-major
+    const std::vector<Tile> block(16, TILE_SAND);
+    world.setRect(62, 62, 4, 4, block.data());
+    check(drainsTo(world, { { 0, 0, 62, 62, 2, 2 }, { 1, 0, 64, 62, 2, 2 }, { 0, 1, 62, 64, 2, 2 }, { 1, 1, 64, 64, 2, 2 } }),
+        "setRect marks its rectangle in each chunk", size, seed);
+
+    // Edits the simulation publishes come in through applySimulationChanges; a liquid-free world,
+    // so the edit posted here is all it publishes
+    WorldSimulationThread simulation(world.getTiles(), seed, 100.f);
+    world.setSimulationThread(&simulation);
+    simulation.start();
+    simulation.postEdit(100, 20, TILE_COBBLESTONE);
+    for (int wait = 0; wait < 500 && world.getTile(100, 20) != TILE_COBBLESTONE; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        world.applySimulationChanges();
+    }
+    simulation.stop();
+    world.setSimulationThread(nullptr);
+    check(world.getTile(100, 20) == TILE_COBBLESTONE, "simulation change applied", size, seed);
+    check(drainsTo(world, { { 1, 0, 100, 20, 1, 1 } }), "applySimulationChanges marks what it applied", size, seed);
+}
+
+struct Test {
+    const char* name;
+    std::function<void()> run;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const Test tests[] = {
+        { "parallel_generation", testParallelGeneration },
+        { "pipeline_orders", testPipelineOrders },
+        { "settled_liquids", testSettledLiquids },
+        { "liquid_seams", testLiquidSeams },
+        { "fused_update", testFusedUpdate },
+        { "liquid_strips", testLiquidStrips },
+        { "cache_round_trip", testCacheRoundTrip },
+        { "liquid_simulator", testLiquidSimulator },
+        { "tick_scheduler", testTickScheduler },
+        { "batched_edits", testBatchedEdits },
+        { "dirty_regions", testDirtyRegions },
+    };
+
+    int ran = 0;
+    for (const Test& test : tests) {
+        if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) continue;
+        const int failuresBefore = g_failures;
+        test.run();
+        std::printf("%-20s %s\n", test.name, g_failures == failuresBefore ? "ok" : "FAILED");
+        ++ran;
+    }
+    if (ran == 0) {
+        std::printf("no test matches \"%s\"\n", filter.c_str());
+        return 1;
+    }
+    return g_failures == 0 ? 0 : 1;
+}